@@ -0,0 +1,201 @@
+#ifndef __ALLOCS_H__
+#define __ALLOCS_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "frametime.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Allocation tracking
+// A build with -DALLOC_TRACKING replaces malloc, calloc, realloc, aligned_alloc, posix_memalign and free for
+// the whole process (raylib and libc included, the executable's definitions interpose theirs) with counting
+// wrappers around glibc's own. Calls and bytes are counted per frame section on the main thread, between
+// sections, and on other threads; the overlay shows the last frame. For headless runs:
+//
+//     gcc -DALLOC_TRACKING -rdynamic main.c -o demo-allocs -lraylib -lGL -lm -lpthread -ldl -lrt -lX11
+//     xvfb-run ./demo-allocs --benchmark 600 --alloc-check [warm up frames]
+//
+// prints the counts after warm up (120 frames by default) with the callers of the first allocations, and
+// exits with status 1 when anything allocated after warm up. Frees are counted but do not fail the check.
+
+#define ALLOC_SLOTS (FRAME_SECTIONS + 2)       // sections, between sections, other threads
+#define ALLOC_OUTSIDE FRAME_SECTIONS
+#define ALLOC_THREADS (FRAME_SECTIONS + 1)
+#define ALLOC_CALLERS 16
+
+typedef struct AllocConfig {
+	bool check;
+	int warmup;
+} AllocConfig;
+
+typedef struct AllocCounts {
+	long long calls;                // malloc, calloc, realloc and aligned allocations
+	long long bytes;                // requested
+	long long frees;
+} AllocCounts;
+
+static const char *allocSlotNames[ALLOC_SLOTS] = { "update", "pixels", "layers", "background", "sprites", "quads", "present", "capture", "between sections", "other threads" };
+
+static AllocConfig ParseAllocArgs(int argc, char **argv) {
+	AllocConfig config = { false, 120 };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--alloc-check") == 0) {
+			config.check = true;
+			if (i + 1 < argc && atoi(argv[i + 1]) > 0) config.warmup = atoi(argv[++i]);
+		}
+	}
+	return config;
+}
+
+#if defined(ALLOC_TRACKING)
+
+#include <unistd.h>
+#include <execinfo.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *pointer);
+
+static AllocCounts allocCurrent[ALLOC_SLOTS];  // this frame; the other threads' slot is updated atomically
+static AllocCounts allocFrame[ALLOC_SLOTS];    // last frame
+static AllocCounts allocTotal[ALLOC_SLOTS];    // after warm up
+static __thread bool allocMainThread;
+static int allocFrames;
+static int allocWarmup = -1;                    // -1 until tracking starts
+static int allocFirstFrame = -1;                // first frame that allocated after warm up
+static void *allocCallers[ALLOC_CALLERS];
+static int allocCallerCount;
+
+static inline void CountAlloc(size_t bytes, bool release, void *caller) {
+	if (allocWarmup < 0) return;
+	if (!allocMainThread) {
+		AllocCounts *c = &allocCurrent[ALLOC_THREADS];
+		__atomic_fetch_add(release ? &c->frees : &c->calls, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&c->bytes, (long long)bytes, __ATOMIC_RELAXED);
+		return;
+	}
+	AllocCounts *c = &allocCurrent[frameSectionCurrent >= 0 ? frameSectionCurrent : ALLOC_OUTSIDE];
+	if (release) { c->frees++; return; }
+	c->calls++;
+	c->bytes += bytes;
+	if (allocFrames > allocWarmup && allocCallerCount < ALLOC_CALLERS) allocCallers[allocCallerCount++] = caller;
+}
+
+void *malloc(size_t size) {
+	CountAlloc(size, false, __builtin_return_address(0));
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	CountAlloc(count*size, false, __builtin_return_address(0));
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+	CountAlloc(size, false, __builtin_return_address(0));
+	return __libc_realloc(pointer, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+	CountAlloc(size, false, __builtin_return_address(0));
+	return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+	CountAlloc(size, false, __builtin_return_address(0));
+	*pointer = __libc_memalign(alignment, size);
+	return (*pointer != NULL) ? 0 : 12;     // ENOMEM
+}
+
+void free(void *pointer) {
+	if (pointer != NULL) CountAlloc(0, true, NULL);
+	__libc_free(pointer);
+}
+
+// Call from the main thread before the main loop
+static void StartAllocTracking(AllocConfig config) {
+	allocMainThread = true;
+	allocWarmup = config.warmup;
+}
+
+// Call at the top of each frame: the counts so far become the last frame's
+static void StepAllocFrame(void) {
+	if (allocWarmup < 0) return;
+	AllocCounts threads;
+	threads.calls = __atomic_exchange_n(&allocCurrent[ALLOC_THREADS].calls, 0, __ATOMIC_RELAXED);
+	threads.bytes = __atomic_exchange_n(&allocCurrent[ALLOC_THREADS].bytes, 0, __ATOMIC_RELAXED);
+	threads.frees = __atomic_exchange_n(&allocCurrent[ALLOC_THREADS].frees, 0, __ATOMIC_RELAXED);
+
+	memcpy(allocFrame, allocCurrent, sizeof(AllocCounts)*ALLOC_THREADS);
+	allocFrame[ALLOC_THREADS] = threads;        // their slot stays the workers', already zeroed
+	memset(allocCurrent, 0, sizeof(AllocCounts)*ALLOC_THREADS);
+	if (allocFrames > allocWarmup) {
+		for (int s = 0; s < ALLOC_SLOTS; s++) {
+			allocTotal[s].calls += allocFrame[s].calls;
+			allocTotal[s].bytes += allocFrame[s].bytes;
+			allocTotal[s].frees += allocFrame[s].frees;
+			if (allocFrame[s].calls > 0 && allocFirstFrame < 0) allocFirstFrame = allocFrames - 1;
+		}
+	}
+	allocFrames++;
+}
+
+// One line for the overlay, the last frame
+static const char *AllocFrameText(void) {
+	static char text[256];
+	long long calls = 0, bytes = 0, frees = 0;
+	for (int s = 0; s < ALLOC_SLOTS; s++) { calls += allocFrame[s].calls; bytes += allocFrame[s].bytes; frees += allocFrame[s].frees; }
+	int length = snprintf(text, sizeof(text), "allocations %lli (%lli bytes), frees %lli", calls, bytes, frees);
+	for (int s = 0; s < ALLOC_SLOTS && length < (int)sizeof(text); s++) {
+		if (allocFrame[s].calls > 0) length += snprintf(text + length, sizeof(text) - length, ", %s %lli", allocSlotNames[s], allocFrame[s].calls);
+	}
+	return text;
+}
+
+// Call right after the main loop: prints the counts after warm up, false when something allocated then
+static bool FinishAllocTracking(void) {
+	if (allocWarmup < 0) return true;
+	StepAllocFrame();       // the last frame
+	int frames = allocFrames - 1 - allocWarmup;
+	long long calls = 0;
+
+	printf("allocations after %i warm up frames, %i frames\n", allocWarmup, frames > 0 ? frames : 0);
+	printf("  %-18s %10s %12s %10s\n", "section", "calls", "bytes", "frees");
+	for (int s = 0; s < ALLOC_SLOTS; s++) {
+		printf("  %-18s %10lli %12lli %10lli\n", allocSlotNames[s], allocTotal[s].calls, allocTotal[s].bytes, allocTotal[s].frees);
+		calls += allocTotal[s].calls;
+	}
+	if (allocFirstFrame >= 0) printf("  first at frame %i\n", allocFirstFrame);
+	if (allocCallerCount > 0) {
+		printf("  first callers:\n");
+		fflush(stdout);
+		backtrace_symbols_fd(allocCallers, allocCallerCount, STDOUT_FILENO);    // writes without allocating
+	}
+	allocWarmup = -1;
+	return calls == 0;
+}
+
+#else
+
+static bool allocUntracked;     // --alloc-check without the tracking build fails rather than passing unchecked
+
+static void StartAllocTracking(AllocConfig config) {
+	if (!config.check) return;
+	TraceLog(LOG_WARNING, "ALLOCS: --alloc-check needs a build with -DALLOC_TRACKING");
+	allocUntracked = true;
+}
+static void StepAllocFrame(void) {}
+static const char *AllocFrameText(void) { return NULL; }
+static bool FinishAllocTracking(void) { return !allocUntracked; }
+
+#endif
+
+#endif
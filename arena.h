@@ -0,0 +1,118 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Frame arena
+// Bump allocator for per-frame scratch data, reset at the start of every frame. Allocations are aligned for
+// SIMD loads. When the block is full, allocations spill into overflow pages; the next reset grows the block
+// to the high-water mark, so the steady state makes no malloc calls at all.
+
+#define FRAME_ARENA_ALIGN 32
+#define FRAME_ARENA_PAGE_SIZE (64*1024)
+
+typedef struct ArenaPage {
+	struct ArenaPage *next;
+	size_t size;
+	size_t used;
+} ArenaPage;
+
+typedef struct FrameArena {
+	unsigned char *base;
+	size_t capacity;
+	size_t used;            // bytes used in the frame, overflow pages included
+	size_t peak;            // high-water mark over all frames
+	ArenaPage *overflow;
+	int overflowPages;      // pages allocated since the start
+	int grows;              // times the block was grown to the high-water mark
+} FrameArena;
+
+static size_t ArenaAlignUp(size_t size) {
+	return (size + FRAME_ARENA_ALIGN - 1) & ~(size_t)(FRAME_ARENA_ALIGN - 1);
+}
+
+static FrameArena InitFrameArena(size_t capacity) {
+	FrameArena arena = { 0 };
+	arena.capacity = ArenaAlignUp(capacity);
+	arena.base = (unsigned char *)aligned_alloc(FRAME_ARENA_ALIGN, arena.capacity);
+	if (arena.base == NULL) {
+		TraceLog(LOG_WARNING, "ARENA: could not allocate %i KB, every allocation goes to overflow pages", (int)(arena.capacity/1024));
+		arena.capacity = 0;
+	}
+	return arena;
+}
+
+static void *FrameArenaOverflow(FrameArena *arena, size_t size) {
+	ArenaPage *page = arena->overflow;
+	if (page == NULL || page->used + size > page->size) {
+		size_t pageSize = size > FRAME_ARENA_PAGE_SIZE ? size : FRAME_ARENA_PAGE_SIZE;
+		page = (ArenaPage *)aligned_alloc(FRAME_ARENA_ALIGN, ArenaAlignUp(sizeof(ArenaPage)) + pageSize);
+		if (page == NULL) {
+			// FRAME_ALLOC callers take the memory as given, nothing sensible can run on without it
+			TraceLog(LOG_ERROR, "ARENA: could not allocate a %i KB overflow page", (int)(pageSize/1024));
+			exit(EXIT_FAILURE);
+		}
+		page->next = arena->overflow;
+		page->size = pageSize;
+		page->used = 0;
+		arena->overflow = page;
+		arena->overflowPages++;
+	}
+
+	void *ptr = (unsigned char *)page + ArenaAlignUp(sizeof(ArenaPage)) + page->used;
+	page->used += size;
+	return ptr;
+}
+
+static void *FrameAlloc(FrameArena *arena, size_t size) {
+	size = ArenaAlignUp(size > 0 ? size : 1);
+
+	void *ptr;
+	if (arena->used + size <= arena->capacity && arena->overflow == NULL) ptr = arena->base + arena->used;
+	else ptr = FrameArenaOverflow(arena, size);
+
+	arena->used += size;
+	if (arena->used > arena->peak) arena->peak = arena->used;
+	return ptr;
+}
+
+#define FRAME_ALLOC(arena, type, count) ((type *)FrameAlloc((arena), sizeof(type)*(count)))
+
+static void ResetFrameArena(FrameArena *arena) {
+	if (arena->overflow != NULL) {
+		while (arena->overflow != NULL) {
+			ArenaPage *next = arena->overflow->next;
+			free(arena->overflow);
+			arena->overflow = next;
+		}
+
+		unsigned char *base = (unsigned char *)aligned_alloc(FRAME_ARENA_ALIGN, ArenaAlignUp(arena->peak));
+		if (base == NULL) {
+			TraceLog(LOG_WARNING, "ARENA: could not grow to %i KB, keeping %i KB", (int)(ArenaAlignUp(arena->peak)/1024), (int)(arena->capacity/1024));
+		} else {
+			free(arena->base);
+			arena->base = base;
+			arena->capacity = ArenaAlignUp(arena->peak);
+			arena->grows++;
+		}
+	}
+	arena->used = 0;
+}
+
+static void FreeFrameArena(FrameArena *arena) {
+	while (arena->overflow != NULL) {
+		ArenaPage *next = arena->overflow->next;
+		free(arena->overflow);
+		arena->overflow = next;
+	}
+	free(arena->base);
+	arena->base = NULL;
+	arena->capacity = 0;
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef __ASSETPACK_H__
+#define __ASSETPACK_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Asset pack
+// Images in an external file, mapped read-only instead of compiled in through data.h, so assets can be swapped
+// without a rebuild. Layout, little endian: a header and the table of contents from offset 0, then every image
+// at an offset aligned to ASSET_PACK_ALIGN. Textures are uploaded straight from the mapping (raylib hands
+// Image.data to glTexImage2D, nothing is copied on our side), then ReleaseAsset() gives the pages back with
+// madvise, so once the demo is running almost none of the pack stays resident. Pages read again later, like
+// the copper gradients, fault back in from the file. Entries with format 0 are raw data (the tracker module).
+//
+//     ./demo --write-pack assets.pak      writes the compiled in images and exits
+//     ./demo --pack assets.pak            loads them from the pack (assets.pak is used when it exists)
+
+#define ASSET_PACK_MAGIC "DPAK"
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGN 4096           // multiple of the page size on every target
+#define ASSET_NAME_SIZE 24
+
+typedef struct AssetPackHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t count;                 // table of contents entries, right after the header
+	uint32_t reserved;
+	uint64_t size;                  // whole file
+} AssetPackHeader;
+
+typedef struct AssetEntry {
+	char name[ASSET_NAME_SIZE];     // zero terminated
+	uint64_t offset;                // multiple of ASSET_PACK_ALIGN
+	uint64_t size;
+	uint32_t width;
+	uint32_t height;
+	uint32_t format;                // raylib PixelFormat
+	uint32_t reserved;
+} AssetEntry;
+
+typedef struct AssetPack {
+	const unsigned char *base;
+	size_t size;
+	const AssetEntry *entries;
+	int count;
+	size_t released;                // bytes given back with madvise
+} AssetPack;
+
+// An image to write, 'data' holding width*height pixels of 'format'; raw data when format is 0
+typedef struct AssetSource {
+	const char *name;
+	const void *data;
+	int width;
+	int height;
+	int format;
+	size_t size;                    // raw data only
+} AssetSource;
+
+typedef struct AssetPackConfig {
+	const char *path;
+	const char *write;
+} AssetPackConfig;
+
+static AssetPackConfig ParseAssetPackArgs(int argc, char **argv) {
+	AssetPackConfig config = { NULL, NULL };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) config.path = argv[++i];
+		else if (strcmp(argv[i], "--write-pack") == 0 && i + 1 < argc) config.write = argv[++i];
+	}
+	return config;
+}
+
+static uint64_t AlignAssetOffset(uint64_t offset) {
+	return (offset + ASSET_PACK_ALIGN - 1) & ~(uint64_t)(ASSET_PACK_ALIGN - 1);
+}
+
+static bool WriteAssetPack(const char *path, const AssetSource *sources, int count) {
+	FILE *file = fopen(path, "wb");
+	if (file == NULL) {
+		TraceLog(LOG_WARNING, "ASSETS: could not write %s", path);
+		return false;
+	}
+
+	AssetEntry *entries = (AssetEntry *)calloc(count, sizeof(AssetEntry));
+	uint64_t offset = AlignAssetOffset(sizeof(AssetPackHeader) + (uint64_t)count*sizeof(AssetEntry));
+	for (int i = 0; i < count; i++) {
+		strncpy(entries[i].name, sources[i].name, ASSET_NAME_SIZE - 1);
+		entries[i].offset = offset;
+		entries[i].size = sources[i].format != 0 ? GetPixelDataSize(sources[i].width, sources[i].height, sources[i].format) : sources[i].size;
+		entries[i].width = sources[i].width;
+		entries[i].height = sources[i].height;
+		entries[i].format = sources[i].format;
+		offset = AlignAssetOffset(offset + entries[i].size);
+	}
+
+	AssetPackHeader header = { { 'D', 'P', 'A', 'K' }, ASSET_PACK_VERSION, (uint32_t)count, 0, offset };
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(entries, sizeof(AssetEntry), count, file) == (size_t)count;
+	for (int i = 0; i < count && ok; i++) {
+		ok = fseek(file, (long)entries[i].offset, SEEK_SET) == 0 && fwrite(sources[i].data, 1, entries[i].size, file) == entries[i].size;
+	}
+	// Pad the last image to a whole page, so every entry maps whole pages
+	if (ok && count > 0 && entries[count - 1].offset + entries[count - 1].size < offset) {
+		ok = fseek(file, (long)offset - 1, SEEK_SET) == 0 && fputc(0, file) != EOF;
+	}
+
+	free(entries);
+	if (fclose(file) != 0) ok = false;
+	if (ok) TraceLog(LOG_INFO, "ASSETS: %i entries, %i KB written to %s", count, (int)(offset/1024), path);
+	else TraceLog(LOG_WARNING, "ASSETS: failed writing %s", path);
+	return ok;
+}
+
+static AssetPack *OpenAssetPack(const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	struct stat st;
+	void *base = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(AssetPackHeader)) {
+		base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);      // the mapping keeps the file
+	if (base == MAP_FAILED) {
+		TraceLog(LOG_WARNING, "ASSETS: could not map %s", path);
+		return NULL;
+	}
+
+	const AssetPackHeader *header = (const AssetPackHeader *)base;
+	const AssetEntry *entries = (const AssetEntry *)(header + 1);
+	size_t size = st.st_size;
+	bool valid = memcmp(header->magic, ASSET_PACK_MAGIC, 4) == 0 && header->version == ASSET_PACK_VERSION && header->size <= size &&
+		sizeof(AssetPackHeader) + (uint64_t)header->count*sizeof(AssetEntry) <= size;
+	for (uint32_t i = 0; valid && i < header->count; i++) {
+		const AssetEntry *e = &entries[i];
+		valid = e->offset % ASSET_PACK_ALIGN == 0 && e->offset <= size && e->size <= size - e->offset && e->name[ASSET_NAME_SIZE - 1] == 0 &&
+			(e->format == 0 || (uint64_t)GetPixelDataSize(e->width, e->height, e->format) <= e->size);
+	}
+	if (!valid) {
+		TraceLog(LOG_WARNING, "ASSETS: %s is not a valid asset pack", path);
+		munmap(base, size);
+		return NULL;
+	}
+
+	AssetPack *pack = (AssetPack *)calloc(1, sizeof(AssetPack));
+	pack->base = (const unsigned char *)base;
+	pack->size = size;
+	pack->entries = entries;
+	pack->count = header->count;
+	TraceLog(LOG_INFO, "ASSETS: %s mapped, %i entries, %i KB", path, pack->count, (int)(size/1024));
+	return pack;
+}
+
+static void CloseAssetPack(AssetPack *pack) {
+	munmap((void *)pack->base, pack->size);
+	free(pack);
+}
+
+static const AssetEntry *FindAsset(const AssetPack *pack, const char *name) {
+	if (pack == NULL) return NULL;
+	for (int i = 0; i < pack->count; i++) {
+		if (strcmp(pack->entries[i].name, name) == 0) return &pack->entries[i];
+	}
+	return NULL;
+}
+
+// The image in place in the mapping when the pack has it, 'fallback' (the compiled in copy) otherwise. The
+// demo reads some images as fixed size RGBA, so an entry must have the fallback's format, width and height;
+// one that does not is skipped with a warning. The pixels are read only: upload them or read them, never
+// write to them.
+static Image LoadAssetImage(const AssetPack *pack, const char *name, Image fallback) {
+	const AssetEntry *e = FindAsset(pack, name);
+	if (e == NULL) return fallback;
+	if (e->format != (uint32_t)fallback.format || e->width != (uint32_t)fallback.width || e->height != (uint32_t)fallback.height) {
+		TraceLog(LOG_WARNING, "ASSETS: %s is %ix%i format %i in the pack, expected %ix%i format %i, using the compiled in copy", name,
+			(int)e->width, (int)e->height, (int)e->format, fallback.width, fallback.height, fallback.format);
+		return fallback;
+	}
+	return (Image) { (void *)(pack->base + e->offset), (int)e->width, (int)e->height, 1, (int)e->format };
+}
+
+// Raw data in place in the mapping, NULL when the pack does not have it
+static const unsigned char *LoadAssetData(const AssetPack *pack, const char *name, size_t *size) {
+	const AssetEntry *e = FindAsset(pack, name);
+	if (e == NULL || e->format != 0) return NULL;
+	*size = e->size;
+	return pack->base + e->offset;
+}
+
+// Starts reading the whole pack in the background, call right after opening it
+static void PrefetchAssetPack(const AssetPack *pack) {
+	madvise((void *)pack->base, pack->size, MADV_WILLNEED);
+}
+
+// Drops the pages of an image once it was uploaded; they are read back from the file if touched again
+static void ReleaseAsset(AssetPack *pack, const char *name) {
+	const AssetEntry *e = FindAsset(pack, name);
+	if (e == NULL) return;
+
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t start = e->offset, end = AlignAssetOffset(e->offset + e->size);
+	start = (start + page - 1)/page*page;           // whole pages only when the system page is larger
+	end = end/page*page;
+	if (end > pack->size) end = pack->size/page*page;
+	if (end <= start) return;
+	if (madvise((void *)(pack->base + start), end - start, MADV_DONTNEED) == 0) pack->released += end - start;
+}
+
+#endif
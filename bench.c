@@ -0,0 +1,699 @@
+// -------------------------------------------------------------------------------------------------------------
+// Headless micro-benchmarks for the demo effects, no window needed.
+//
+//     gcc -O2 -march=native bench.c -o bench -lraylib -lGL -lm -lpthread -ldl -lrt -lX11
+//     ./bench [frames]
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "arena.h"
+#include "pixelfx.h"
+#include "blit.h"
+#include "sprites.h"
+#include "starfield.h"
+#include "effects.h"
+#include "cloth.h"
+#include "cull.h"
+#include "qoi.h"
+#include "tracker.h"
+#include "pcmcache.h"
+#include "data.h"
+
+static double Now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Retired instructions of this thread, where the kernel lets us count them (-1 otherwise)
+static int OpenInstructionCounter(void) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long long ReadInstructionCounter(int fd) {
+	long long count = 0;
+	if (fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+	return count;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Effect kernels
+// Each frame runs the update and emit path of one effect against a reset frame arena. Nothing is submitted to
+// GL, the textures are placeholders with the real sizes.
+
+typedef void (*BenchFrame)(void *context, FrameArena *arena, int frame);
+
+static int instructionCounter = -1;
+static int benchFailures = 0;           // results that differ from their reference, the exit status
+
+static void RunBench(const char *name, const char *size, BenchFrame run, void *context, int frames) {
+	FrameArena arena = InitFrameArena(64*1024);
+
+	// Warm up, so the arena is grown to its high-water mark
+	for (int i = 0; i < 8; i++) { ResetFrameArena(&arena); run(context, &arena, i); }
+
+	size_t bytes = 0;
+	int grows = arena.grows, pages = arena.overflowPages;
+	if (instructionCounter >= 0) { ioctl(instructionCounter, PERF_EVENT_IOC_RESET, 0); ioctl(instructionCounter, PERF_EVENT_IOC_ENABLE, 0); }
+	double start = Now();
+	for (int i = 0; i < frames; i++) {
+		ResetFrameArena(&arena);
+		run(context, &arena, i);
+		bytes += arena.used;
+	}
+	double ns = (Now() - start)*1e9/frames;
+	if (instructionCounter >= 0) ioctl(instructionCounter, PERF_EVENT_IOC_DISABLE, 0);
+	long long instructions = ReadInstructionCounter(instructionCounter);
+
+	char perFrame[32] = "n/a";
+	if (instructions >= 0) snprintf(perFrame, sizeof(perFrame), "%lld", instructions/frames);
+	printf("  %-22s %-12s %12.0f %10.1f %14s %s\n", name, size, ns, bytes/1024.0/frames, perFrame,
+		(arena.grows != grows || arena.overflowPages != pages) ? "(arena grew)" : "");
+	FreeFrameArena(&arena);
+}
+
+static const Texture2D benchCopper = { 1, 4, 56, 1, UNCOMPRESSED_R8G8B8A8 };
+static const Texture2D benchLogo = { 2, 636, 108, 1, UNCOMPRESSED_R8G8B8A8 };
+static const Texture2D benchFont = { 3, 2048, 32, 1, UNCOMPRESSED_R8G8B8A8 };
+static const Texture2D benchFont2 = { 4, 16, 946, 1, UNCOMPRESSED_R8G8B8A8 };
+static const Texture2D benchBall = { 5, 30, 30, 1, UNCOMPRESSED_R8G8B8A8 };
+
+// Starfields, MAXSTARS stars each, into one sprite batch
+typedef struct StarsBench { Starfield2D *fields; int count; SpriteBatch batch; } StarsBench;
+
+static void StarsFrame(void *context, FrameArena *arena, int frame) {
+	StarsBench *b = (StarsBench *)context;
+	ClearSpriteBatch(&b->batch);
+	for (int i = 0; i < b->count; i++) Update_Starfield2D(&b->fields[i], (Vector2) {0,-1}, &b->batch);
+}
+
+static void BenchStars(int fields, int frames) {
+	StarsBench b;
+	b.fields = (Starfield2D *)malloc(fields*sizeof(Starfield2D));
+	b.count = fields;
+	b.batch = LoadSpriteBatch(benchBall, fields*MAXSTARS);
+	for (int i = 0; i < fields; i++) {
+		b.fields[i] = Init_Starfield2D(benchBall, (Vector2) {-32,-32}, (Vector2) {1280+32,720+32});
+		SetSpeed_Starfield2D(&b.fields[i], (Vector2) {0.5f + (i % 8)*0.5f, 0.5f + (i % 8)*0.5f});
+	}
+	char size[32];
+	snprintf(size, sizeof(size), "%i stars", fields*MAXSTARS);
+	RunBench("Update_Starfield2D", size, StarsFrame, &b, frames);
+	UnloadSpriteBatch(&b.batch);
+	for (int i = 0; i < fields; i++) Unload_Starfield2D(&b.fields[i]);
+	free(b.fields);
+}
+
+// Copper columns
+typedef struct CopperBench { Texture2D copper[11]; int columns; int layers; } CopperBench;
+
+static void CopperFrame(void *context, FrameArena *arena, int frame) {
+	CopperBench *b = (CopperBench *)context;
+	float t = frame/60.0f;
+	QuadList quads = AllocQuadList(arena, b->columns*b->layers);
+	EmitCopperColumns(&quads, b->copper, 11, b->columns, b->layers, 1280, t, 0.07f, 300, 0.001f + 0.01f*sinf(t), 200, 112);
+}
+
+static void BenchCopper(int columns, int layers, int frames) {
+	CopperBench b;
+	b.columns = columns;
+	b.layers = layers;
+	for (int i = 0; i < 11; i++) b.copper[i] = benchCopper;
+	char size[32];
+	snprintf(size, sizeof(size), "%ix%i", columns, layers);
+	RunBench("copper columns", size, CopperFrame, &b, frames);
+}
+
+// Logo rows
+typedef struct LogoBench { int rows; } LogoBench;
+
+static void LogoFrame(void *context, FrameArena *arena, int frame) {
+	LogoBench *b = (LogoBench *)context;
+	QuadList quads = AllocQuadList(arena, b->rows);
+	EmitLogoRows(&quads, benchLogo, b->rows, 322, 0, frame*0.1f, 0.001f);
+}
+
+static void BenchLogo(int rows, int frames) {
+	LogoBench b = { rows };
+	char size[32];
+	snprintf(size, sizeof(size), "%i rows", rows);
+	RunBench("logo rows", size, LogoFrame, &b, frames);
+}
+
+// Sine flag over a cached glyph layer of the demo size (32x12 glyphs of 16px)
+typedef struct FlagBench { SineFlag flag; LayerCache layer; } FlagBench;
+
+static void FlagFrame(void *context, FrameArena *arena, int frame) {
+	FlagBench *b = (FlagBench *)context;
+	QuadList quads = AllocQuadList(arena, 2*b->flag.columns*b->flag.rows);
+	EmitSineFlag(&quads, arena, &b->flag, &b->layer, 1280);
+}
+
+static void BenchFlag(int columns, int rows, int frames) {
+	FlagBench b;
+	memset(&b, 0, sizeof(b));
+	b.flag = (SineFlag) { columns, rows, 32, 16, 1, 0, 0 };
+	b.layer.target.texture = (Texture2D) { 6, 32*16, 12*16, 1, UNCOMPRESSED_R8G8B8A8 };
+	b.layer.valid = true;
+	char size[32];
+	snprintf(size, sizeof(size), "%ix%i", columns, rows);
+	RunBench("sine flag", size, FlagFrame, &b, frames);
+}
+
+// Scrollers, over texts of 'length' characters
+typedef struct ScrollerBench { BitmapFont font; BitmapText text; float ySin[4096]; } ScrollerBench;
+
+static void SkewScrollerFrame(void *context, FrameArena *arena, int frame) {
+	ScrollerBench *b = (ScrollerBench *)context;
+	float x = 1280 - (frame*8 % (b->text.length*32 + 1280));
+	QuadList quads = AllocQuadList(arena, 1280/32 + 4);
+	EmitSkewScroller(&quads, arena, &b->font, &b->text, x, 580, 1280, (Vector2) {32,0});
+}
+
+static void WaveScrollerFrame(void *context, FrameArena *arena, int frame) {
+	ScrollerBench *b = (ScrollerBench *)context;
+	float x = 1280 - (frame*5 % (b->text.length*16 + 1280));
+	QuadList quads = AllocQuadList(arena, b->text.length);
+	EmitWaveScroller(&quads, arena, &b->font, &b->text, x, 680, 1280, b->ySin, 0.5f);
+}
+
+static void BenchScrollers(int length, int frames) {
+	char *text = (char *)malloc(length + 1);
+	for (int i = 0; i < length; i++) text[i] = 'A' + i % 26;
+	text[length] = '\0';
+
+	ScrollerBench *b = (ScrollerBench *)malloc(sizeof(ScrollerBench));
+	for (int i = 0; i < 4096; i++) b->ySin[i] = sinf(i*PI*2/24)*20;
+	char size[32];
+	snprintf(size, sizeof(size), "%i chars", length);
+
+	b->font = LoadBitmapFont(benchFont, 32, 32, 32);
+	b->text = LoadBitmapText(&b->font, text);
+	RunBench("skew scroller", size, SkewScrollerFrame, b, frames);
+	UnloadBitmapText(&b->text);
+
+	if (length <= 4096) {
+		b->font = LoadBitmapFont(benchFont2, 16, 16, 32);
+		b->text = LoadBitmapText(&b->font, text);
+		RunBench("wave scroller", size, WaveScrollerFrame, b, frames);
+		UnloadBitmapText(&b->text);
+	}
+	free(b);
+	free(text);
+}
+
+// DrawTextureProSK vertex math, 'count' skewed quads per frame
+typedef struct SkewBench { int count; float sink; } SkewBench;
+
+static void SkewFrame(void *context, FrameArena *arena, int frame) {
+	SkewBench *b = (SkewBench *)context;
+	float sink = 0;
+	for (int i = 0; i < b->count; i++) {
+		SkewQuad q = ComputeSkewQuad(benchFont, (Rectangle) { (i & 63)*32, 0, 32, 32 },
+			(Rectangle) { i & 1023, 580, 32, 64 }, (Vector2) {32,0}, (i & 7) ? 0 : frame);
+		sink += q.position[2].x + q.texcoord[2].y;
+	}
+	b->sink += sink;
+}
+
+static void BenchSkew(int count, int frames) {
+	SkewBench b = { count, 0 };
+	char size[32];
+	snprintf(size, sizeof(size), "%i quads", count);
+	RunBench("DrawTextureProSK math", size, SkewFrame, &b, frames);
+}
+
+// Copper columns emitted then culled against the frame buffer, amp 300 swings part of them off screen
+static void CullFrame(void *context, FrameArena *arena, int frame) {
+	CopperBench *b = (CopperBench *)context;
+	float t = frame/60.0f;
+	QuadList quads = AllocQuadList(arena, b->columns*b->layers);
+	EmitCopperColumns(&quads, b->copper, 11, b->columns, b->layers, 1280, t, 0.07f, 300, 0.001f + 0.01f*sinf(t), 200, 112);
+	CullQuads(&quads, (Rectangle) {0, 0, 1280, 720}, CULL_COPPER, arena);
+}
+
+static void BenchCull(int columns, int layers, int frames) {
+	CopperBench b;
+	b.columns = columns;
+	b.layers = layers;
+	for (int i = 0; i < 11; i++) b.copper[i] = benchCopper;
+	char size[32];
+	snprintf(size, sizeof(size), "%ix%i", columns, layers);
+	RunBench("copper columns + cull", size, CullFrame, &b, frames);
+}
+
+static void BenchEffects(int frames) {
+	instructionCounter = OpenInstructionCounter();
+
+	printf("effects (update + emit, no GL submit)\n");
+	printf("  %-22s %-12s %12s %10s %14s\n", "kernel", "size", "ns/frame", "KB/frame", "instr/frame");
+
+	BenchStars(8, frames); BenchStars(64, frames); BenchStars(1024, frames);
+	BenchCopper(160, 11, frames); BenchCopper(320, 22, frames); BenchCopper(640, 44, frames);
+	BenchLogo(108, frames); BenchLogo(432, frames); BenchLogo(1728, frames);
+	BenchFlag(32, 12, frames); BenchFlag(64, 24, frames); BenchFlag(128, 48, frames);
+	BenchScrollers(256, frames); BenchScrollers(4096, frames);
+	BenchSkew(1000, frames); BenchSkew(10000, frames); BenchSkew(100000, frames);
+	BenchCull(160, 11, frames); BenchCull(640, 44, frames);
+
+	if (instructionCounter >= 0) close(instructionCounter);
+	printf("\n");
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Plasma kernel, per thread count
+static void BenchPlasma(int width, int height, int frames) {
+	PixelBuffer buffer = LoadPixelBuffer(width, height);
+	PixelBuffer reference = LoadPixelBuffer(width, height);
+	if (buffer.pixels == NULL || reference.pixels == NULL) {
+		printf("plasma %ix%i: out of memory\n\n", width, height);
+		benchFailures++;
+		UnloadPixelBuffer(&reference);
+		UnloadPixelBuffer(&buffer);
+		return;
+	}
+	FrameArena arena = InitFrameArena(2*(width + height) + 1024);
+	int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+	InitPlasma();
+
+	// SIMD and scalar paths must agree to the bit
+	PlasmaParams params = PreparePlasma(width, height, 1.25f,
+		FRAME_ALLOC(&arena, unsigned char, width), FRAME_ALLOC(&arena, unsigned char, width + height), FRAME_ALLOC(&arena, unsigned char, height));
+	PlasmaKernel(&buffer, 0, height, &params);
+	PlasmaKernelScalar(&reference, 0, height, &params);
+	bool exact = memcmp(buffer.pixels, reference.pixels, (size_t)width*height*sizeof(Color)) == 0;
+	if (!exact) benchFailures++;
+
+	printf("plasma %ix%i (SIMD %s scalar)\n", width, height, exact ? "==" : "!=");
+	printf("  threads     ms/frame    Mpix/s   speedup\n");
+
+	double single = 0;
+	for (int threads = 1; ; threads *= 2) {
+		if (threads > cores) threads = cores;
+		PixelPool *pool = LoadPixelPool(threads);
+		if (pool == NULL) { benchFailures++; break; }
+
+		double start = Now();
+		for (int i = 0; i < frames; i++) {
+			ResetFrameArena(&arena);
+			params = PreparePlasma(width, height, i/60.0f,
+				FRAME_ALLOC(&arena, unsigned char, width), FRAME_ALLOC(&arena, unsigned char, width + height), FRAME_ALLOC(&arena, unsigned char, height));
+			RunPixelKernel(pool, &buffer, PlasmaKernel, &params);
+		}
+		double ms = (Now() - start)*1000.0/frames;
+		if (threads == 1) single = ms;
+
+		printf("  %7i  %11.3f  %8.1f  %8.2fx\n", pool->threadCount, ms, width*height/(ms*1000.0), single/ms);
+		UnloadPixelPool(pool);
+		if (threads == cores) break;
+	}
+
+	FreeFrameArena(&arena);
+	UnloadPixelBuffer(&reference);
+	UnloadPixelBuffer(&buffer);
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Cloth flag steps, per grid size and thread count, against a 4 ms budget
+static void BenchCloth(int columns, int rows, int steps) {
+	int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	ClothFlag reference = LoadClothFlag(columns, rows, 4, 1280);
+	PixelPool *single = LoadPixelPool(1);
+	if (reference.x == NULL || single == NULL) {
+		printf("cloth %ix%i: out of memory\n\n", columns, rows);
+		benchFailures++;
+		if (single != NULL) UnloadPixelPool(single);
+		UnloadClothFlag(&reference);
+		return;
+	}
+	for (int i = 0; i < steps; i++) SimulateClothFlag(&reference, single);
+	UnloadPixelPool(single);
+
+	printf("cloth %ix%i, %i iterations\n", columns, rows, reference.iterations);
+	printf("  threads      ms/step   speedup    budget   same\n");
+
+	double first = 0;
+	for (int threads = 1; ; threads *= 2) {
+		if (threads > cores) threads = cores;
+		PixelPool *pool = LoadPixelPool(threads);
+		ClothFlag cloth = LoadClothFlag(columns, rows, 4, 1280);
+		if (pool == NULL || cloth.x == NULL) {
+			benchFailures++;
+			if (pool != NULL) UnloadPixelPool(pool);
+			UnloadClothFlag(&cloth);
+			break;
+		}
+
+		double start = Now();
+		for (int i = 0; i < steps; i++) SimulateClothFlag(&cloth, pool);
+		double ms = (Now() - start)*1000.0/steps;
+		if (threads == 1) first = ms;
+
+		// Passes touch disjoint particles, so every thread count must give the single thread result
+		bool same = memcmp(cloth.x, reference.x, 3*(size_t)rows*cloth.stride*sizeof(float)) == 0;
+		if (!same) benchFailures++;
+		printf("  %7i  %11.3f  %8.2fx  %8s  %5s\n", pool->threadCount, ms, first/ms, ms <= 4.0 ? "ok" : "over", same ? "yes" : "NO");
+		UnloadClothFlag(&cloth);
+		UnloadPixelPool(pool);
+		if (threads == cores) break;
+	}
+	UnloadClothFlag(&reference);
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// CPU blits of the demo's images into a 720p buffer, per row kernel, checked against the scalar rows
+typedef struct BlitCase {
+	const char *name;
+	BlitSource source;
+	Rectangle from;
+	Vector2 size;           // drawn size
+	int count;              // blits per frame, spread over the buffer and past its edges
+	Color tint;
+	BlitMode mode;
+} BlitCase;
+
+static size_t RunBlitCase(PixelBuffer *buffer, const BlitCase *c, BlitRow row) {
+	size_t pixels = 0;
+	for (int i = 0; i < c->count; i++) {
+		Rectangle to = { (i*397) % (buffer->width + (int)c->size.x) - c->size.x*0.5f, (i*211) % (buffer->height + (int)c->size.y) - c->size.y*0.5f, c->size.x, c->size.y };
+		BlitParams p = PrepareBlit(buffer, c->source, c->from, to, c->tint, c->mode);
+		p.row = row;
+		BlitKernel(buffer, p.y0, p.y1, &p);
+		pixels += (size_t)(p.x1 - p.x0)*(p.y1 - p.y0);
+	}
+	return pixels;
+}
+
+static void BenchBlit(int frames) {
+	PixelBuffer buffer = LoadPixelBuffer(1280, 720);
+	PixelBuffer reference = LoadPixelBuffer(1280, 720);
+	PixelBuffer screen = LoadPixelBuffer(1280, 720);
+	Color *fade = (Color *)malloc(1280*720*sizeof(Color));
+	if (buffer.pixels == NULL || reference.pixels == NULL || screen.pixels == NULL || fade == NULL) {
+		printf("blit: out of memory\n\n");
+		benchFailures++;
+		free(fade);
+		UnloadPixelBuffer(&screen);
+		UnloadPixelBuffer(&reference);
+		UnloadPixelBuffer(&buffer);
+		return;
+	}
+	for (int i = 0; i < 1280*720; i++) fade[i] = (Color) { i*7, i*13, i >> 4, (i*31) >> 3 };
+
+	BlitSource ball = { (const Color *)ball1_data, 30, 30 };
+	BlitSource font = { (const Color *)font_data, 2048, 32 };
+	BlitSource logo = { (const Color *)logo_data, 636, 108 };
+	BlitSource full = { fade, 1280, 720 };
+	const BlitCase cases[] = {
+		{ "logo copy", logo, { 0, 0, 636, 108 }, { 636, 108 }, 16, WHITE, BLIT_COPY },
+		{ "logo rows x1.5", logo, { 0, 0, 636, 1 }, { 954, 2 }, 108, WHITE, BLIT_ALPHA },
+		{ "balls", ball, { 0, 0, 30, 30 }, { 30, 30 }, 1000, WHITE, BLIT_ALPHA },
+		{ "balls tinted", ball, { 0, 0, 30, 30 }, { 30, 30 }, 1000, (Color) { 255, 160, 64, 200 }, BLIT_ALPHA },
+		{ "glyphs x2 tinted", font, { 32*5, 0, 32, 32 }, { 64, 64 }, 300, (Color) { 96, 255, 128, 255 }, BLIT_ALPHA },
+		{ "glyphs x0.75", font, { 32*9, 0, 32, 32 }, { 24, 24 }, 2000, WHITE, BLIT_ALPHA },
+		{ "fullscreen alpha", full, { 0, 0, 1280, 720 }, { 1280, 720 }, 1, WHITE, BLIT_ALPHA },
+	};
+	struct { const char *name; BlitRow row; } rows[] = {
+		{ "scalar", BlitRowScalar },
+#if defined(__SSE2__)
+		{ "sse2", BlitRowSse2 },
+#endif
+#if defined(__AVX2__)
+		{ "avx2", BlitRowAvx2 },
+#endif
+	};
+	int rowCount = sizeof(rows)/sizeof(rows[0]);
+
+	// Something to blend over
+	InitPlasma();
+	PlasmaParams plasmaParams = PreparePlasma(1280, 720, 0.5f, (unsigned char *)malloc(1280), (unsigned char *)malloc(2000), (unsigned char *)malloc(720));
+	plasmaParams.alpha = 160;
+	PlasmaKernelScalar(&screen, 0, 720, &plasmaParams);
+
+	printf("blit into 1280x720, GB/s of destination pixels\n");
+	printf("  %-18s %10s", "case", "MB/frame");
+	for (int r = 0; r < rowCount; r++) printf(" %9s", rows[r].name);
+	printf("  bit exact\n");
+
+	for (int c = 0; c < (int)(sizeof(cases)/sizeof(cases[0])); c++) {
+		memcpy(reference.pixels, screen.pixels, 1280*720*sizeof(Color));
+		size_t pixels = RunBlitCase(&reference, &cases[c], BlitRowScalar);
+		printf("  %-18s %10.2f", cases[c].name, pixels*4/1e6);
+
+		bool exact = true;
+		for (int r = 0; r < rowCount; r++) {
+			memcpy(buffer.pixels, screen.pixels, 1280*720*sizeof(Color));
+			RunBlitCase(&buffer, &cases[c], rows[r].row);
+			exact &= memcmp(buffer.pixels, reference.pixels, 1280*720*sizeof(Color)) == 0;
+
+			double start = Now();
+			for (int i = 0; i < frames; i++) RunBlitCase(&buffer, &cases[c], rows[r].row);
+			printf(" %9.2f", pixels*4.0*frames/((Now() - start)*1e9));
+		}
+		if (!exact) benchFailures++;
+		printf("  %s\n", exact ? "yes" : "NO");
+	}
+	printf("\n");
+
+	free(plasmaParams.columnWave);
+	free(plasmaParams.diagonalWave);
+	free(plasmaParams.rowWave);
+	free(fade);
+	UnloadPixelBuffer(&screen);
+	UnloadPixelBuffer(&reference);
+	UnloadPixelBuffer(&buffer);
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// QOI encode and decode of a frame, plasma (worst case, no runs) and mostly black (typical demo frame)
+static void BenchQoi(int width, int height, int frames) {
+	PixelBuffer frame = LoadPixelBuffer(width, height);
+	PixelBuffer decoded = LoadPixelBuffer(width, height);
+	unsigned char *data = (unsigned char *)malloc(QoiMaxSize(width, height));
+	if (frame.pixels == NULL || decoded.pixels == NULL || data == NULL) {
+		printf("qoi %ix%i: out of memory\n\n", width, height);
+		benchFailures++;
+		free(data);
+		UnloadPixelBuffer(&decoded);
+		UnloadPixelBuffer(&frame);
+		return;
+	}
+	FrameArena arena = InitFrameArena(2*(width + height) + 1024);
+
+	printf("qoi %ix%i\n", width, height);
+	printf("  %-10s %10s %10s %10s %10s\n", "frame", "KB", "encode ms", "decode ms", "roundtrip");
+
+	for (int pattern = 0; pattern < 2; pattern++) {
+		InitPlasma();
+		PlasmaParams params = PreparePlasma(width, height, 1.25f,
+			FRAME_ALLOC(&arena, unsigned char, width), FRAME_ALLOC(&arena, unsigned char, width + height), FRAME_ALLOC(&arena, unsigned char, height));
+		PlasmaKernel(&frame, 0, height, &params);
+		if (pattern == 1) {
+			// Black with a band of plasma, like the copper over an empty screen
+			for (int y = 0; y < height; y++) {
+				if (y < height/3 || y > height/2) memset(frame.pixels + (size_t)y*width, 0, width*sizeof(Color));
+			}
+			for (int i = 0; i < width*height; i++) frame.pixels[i].a = 255;
+		}
+
+		size_t size = 0;
+		double start = Now();
+		for (int i = 0; i < frames; i++) size = EncodeQoi(frame.pixels, width, height, data);
+		double encodeMs = (Now() - start)*1000.0/frames;
+
+		start = Now();
+		for (int i = 0; i < frames; i++) DecodeQoi(data, size, decoded.pixels);
+		double decodeMs = (Now() - start)*1000.0/frames;
+
+		bool exact = memcmp(frame.pixels, decoded.pixels, (size_t)width*height*sizeof(Color)) == 0;
+		if (!exact) benchFailures++;
+		printf("  %-10s %10i %10.2f %10.2f %10s\n", pattern ? "black" : "plasma", (int)(size/1024), encodeMs, decodeMs, exact ? "exact" : "FAILED");
+	}
+	printf("\n");
+
+	FreeFrameArena(&arena);
+	free(data);
+	UnloadPixelBuffer(&decoded);
+	UnloadPixelBuffer(&frame);
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Music: CPU per second of playback. Decoding the whole track is the work a stream does over one loop; the PCM
+// cache only copies each buffer, from memory or from the mapped cache file, into raylib's stream buffer.
+static double FeedPcmTrack(MusicTrack *track, unsigned char *streamBuffer, int loops) {
+	size_t bufferBytes = (size_t)PCM_STREAM_FRAMES*track->pcm.channels*(track->pcm.sampleSize/8);
+	int buffers = (int)(((unsigned long long)track->pcm.frames*loops + PCM_STREAM_FRAMES - 1)/PCM_STREAM_FRAMES);
+	track->cursor = 0;
+
+	double start = Now();
+	for (int i = 0; i < buffers; i++) memcpy(streamBuffer, ReadPcmFrames(track, PCM_STREAM_FRAMES), bufferBytes);     // UpdateAudioStream's copy
+	return (Now() - start)*1000.0;
+}
+
+static void BenchMusic(const char *fileName) {
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL) {
+		printf("music: %s not found, skipped\n\n", fileName);
+		return;
+	}
+	fclose(file);
+
+	double start = Now();
+	MusicTrack track = { MUSIC_CACHE_MEMORY };
+	if (!DecodePcmTrack(fileName, &track.pcm)) {
+		printf("music: %s could not be decoded, skipped\n\n", fileName);
+		return;
+	}
+	double decodeMs = (Now() - start)*1000.0;
+	double seconds = (double)track.pcm.frames/track.pcm.sampleRate;
+	size_t bufferBytes = (size_t)PCM_STREAM_FRAMES*track.pcm.channels*(track.pcm.sampleSize/8);
+	track.wrap = (unsigned char *)malloc(bufferBytes);
+	unsigned char *streamBuffer = (unsigned char *)malloc(bufferBytes);
+	const int loops = 4;
+
+	printf("music %s, %.1f s, %i Hz, %i channels, %i KB of PCM\n", fileName, seconds, track.pcm.sampleRate, track.pcm.channels, (int)(PcmTrackBytes(&track.pcm)/1024));
+	printf("  %-22s %12s %16s %10s\n", "mode", "startup ms", "us per s played", "core %");
+	printf("  %-22s %12s %16.1f %10.3f\n", "stream (vorbis)", "-", decodeMs*1000.0/seconds, decodeMs/seconds/10.0);
+
+	double feedMs = FeedPcmTrack(&track, streamBuffer, loops);
+	printf("  %-22s %12.1f %16.1f %10.3f\n", "memory", decodeMs, feedMs*1000.0/(seconds*loops), feedMs/(seconds*loops)/10.0);
+	UnloadPcmTrack(&track.pcm);
+
+	// Disk cache in a scratch directory: first start decodes and writes it, the next ones hash the file and map it
+	char directory[] = "/tmp/pcmbenchXXXXXX";
+	if (mkdtemp(directory) != NULL) {
+		MusicCacheConfig config = { MUSIC_CACHE_DISK, directory };
+		start = Now();
+		bool built = LoadPcmTrack(fileName, config, &track.pcm);
+		double buildMs = (Now() - start)*1000.0;
+		if (built) UnloadPcmTrack(&track.pcm);
+
+		start = Now();
+		if (built && LoadPcmTrack(fileName, config, &track.pcm)) {
+			double mapMs = (Now() - start)*1000.0;
+			feedMs = FeedPcmTrack(&track, streamBuffer, loops);
+			printf("  %-22s %12.1f %16s %10s\n", "disk, first start", buildMs, "-", "-");
+			printf("  %-22s %12.1f %16.1f %10.3f\n", "disk", mapMs, feedMs*1000.0/(seconds*loops), feedMs/(seconds*loops)/10.0);
+			UnloadPcmTrack(&track.pcm);
+		}
+
+		char path[512];
+		snprintf(path, sizeof(path), "%s/%016llx.pcm", directory, (unsigned long long)HashPcmSource(fileName));
+		remove(path);
+		rmdir(directory);
+	}
+	printf("\n");
+
+	free(streamBuffer);
+	free(track.wrap);
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Tracker mixer: cost per channel at 48 kHz. Every channel plays a looped sample at its own pitch, mixed in
+// TRACKER_CHUNK frames and converted to 16 bit like the mixer thread does, with each build of the resampler.
+static double BenchTrackerMix(TrackerMixFn mix, TrackerVoice *voices, int channels, int seconds, short *out) {
+	static float buffer[TRACKER_CHUNK*2];
+	int chunks = TRACKER_RATE*seconds/TRACKER_CHUNK;
+
+	double start = Now();
+	for (int i = 0; i < chunks; i++) {
+		memset(buffer, 0, sizeof(buffer));
+		for (int c = 0; c < channels; c++) MixTrackerVoice(&voices[c], buffer, TRACKER_CHUNK, mix);
+		ConvertTrackerFrames(buffer, out, TRACKER_CHUNK*2);
+	}
+	return Now() - start;
+}
+
+static void BenchTracker(int seconds) {
+	const int counts[] = { 1, 4, 8, 16, 32 };
+	struct { const char *name; TrackerMixFn mix; } mixers[] = {
+		{ "scalar", MixTrackerRunScalar },
+#if defined(__SSE2__)
+		{ "sse2", MixTrackerRunSse2 },
+#endif
+#if defined(__AVX2__)
+		{ "avx2", MixTrackerRunAvx2 },
+#endif
+	};
+	int mixerCount = sizeof(mixers)/sizeof(mixers[0]);
+
+	TrackerSample sample = { NULL, 8192, 1024, 8192, false, 64, 0, 0, 128 };
+	sample.data = (float *)malloc((sample.length + TRACKER_GUARD)*sizeof(float));
+	for (int i = 0; i < sample.length; i++) sample.data[i] = sinf(i*0.05f) + 0.25f*sinf(i*0.31f);
+	FinishTrackerSample(&sample);
+	short *out = (short *)malloc(TRACKER_CHUNK*2*sizeof(short));
+	short *reference = (short *)malloc(TRACKER_CHUNK*2*sizeof(short));
+
+	printf("tracker mixer, %i s of audio at %i Hz\n", seconds, TRACKER_RATE);
+	printf("  %-8s %8s %16s %12s %10s\n", "mixer", "channels", "us per channel-s", "core %", "max diff");
+	for (int m = 0; m < mixerCount; m++) {
+		for (int n = 0; n < (int)(sizeof(counts)/sizeof(counts[0])); n++) {
+			TrackerVoice voices[TRACKER_MAX_CHANNELS];
+			for (int c = 0; c < counts[n]; c++) {
+				// Steps from about a fifth to twice the sample rate, like notes across a few octaves
+				voices[c] = (TrackerVoice) { &sample, 0, (int64_t)((0.2 + 0.06*c)*4294967296.0), 0.3f, 0.2f };
+			}
+			double elapsed = BenchTrackerMix(mixers[m].mix, voices, counts[n], seconds, out);
+
+			// One chunk against the scalar mixer from the same start
+			for (int c = 0; c < counts[n]; c++) voices[c].position = 0;
+			TrackerVoice scalar[TRACKER_MAX_CHANNELS];
+			memcpy(scalar, voices, sizeof(voices));
+			float a[TRACKER_CHUNK*2] = { 0 }, b[TRACKER_CHUNK*2] = { 0 };
+			for (int c = 0; c < counts[n]; c++) {
+				MixTrackerVoice(&voices[c], a, TRACKER_CHUNK, mixers[m].mix);
+				MixTrackerVoice(&scalar[c], b, TRACKER_CHUNK, MixTrackerRunScalar);
+			}
+			ConvertTrackerFrames(a, out, TRACKER_CHUNK*2);
+			ConvertTrackerFrames(b, reference, TRACKER_CHUNK*2);
+			int maxDiff = 0;
+			for (int i = 0; i < TRACKER_CHUNK*2; i++) if (abs(out[i] - reference[i]) > maxDiff) maxDiff = abs(out[i] - reference[i]);
+
+			printf("  %-8s %8i %16.1f %12.3f %10i\n", mixers[m].name, counts[n], elapsed*1e6/((double)seconds*counts[n]), elapsed/seconds*100.0, maxDiff);
+		}
+	}
+	printf("\n");
+
+	free(reference);
+	free(out);
+	free(sample.data);
+}
+
+int main(int argc, char **argv) {
+	int frames = (argc > 1) ? atoi(argv[1]) : 200;
+	if (frames < 1) frames = 1;
+
+	BenchEffects(frames);
+	BenchQoi(1280, 720, frames/10 + 1);
+	BenchPlasma(640, 360, frames);
+	BenchPlasma(1280, 720, frames);
+	BenchPlasma(1920, 1080, frames);
+	BenchBlit(frames);
+	BenchCloth(32, 12, frames);
+	BenchCloth(64, 64, frames);
+	BenchCloth(128, 128, frames/4 + 1);
+	BenchCloth(256, 256, frames/10 + 1);
+	BenchMusic("NTMMEG.ogg");
+	BenchTracker(20);
+
+	if (benchFailures > 0) printf("%i results differ from their reference\n", benchFailures);
+	return benchFailures > 0 ? 1 : 0;
+}
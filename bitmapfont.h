@@ -0,0 +1,127 @@
+#ifndef __BITMAPFONT_H__
+#define __BITMAPFONT_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Bitmap fonts
+// Both demo fonts are strips of fixed size glyphs starting at ASCII 32: font_data is horizontal (2048x32),
+// font2_data is vertical (16x946). The glyph table is built once per font, strings are turned into glyph
+// index arrays once, and the layout functions produce quads for a whole run of text.
+
+#define BITMAPFONT_MAX_GLYPHS 128
+
+typedef struct BitmapGlyph {
+	Rectangle source;
+	float advance;
+} BitmapGlyph;
+
+typedef struct BitmapFont {
+	Texture2D texture;
+	int glyphWidth;
+	int glyphHeight;
+	int glyphCount;
+	BitmapGlyph glyphs[BITMAPFONT_MAX_GLYPHS];
+	unsigned char map[256];     // character to glyph index, out of range characters map to the blank glyph
+} BitmapFont;
+
+typedef struct BitmapText {
+	unsigned char *glyphs;
+	int length;
+} BitmapText;
+
+typedef struct GlyphQuad {
+	Rectangle source;
+	Rectangle dest;
+	int index;                  // position of the glyph in the text
+} GlyphQuad;
+
+// Glyphs are laid out along the longest side of the texture, the first one is 'firstChar'
+static BitmapFont LoadBitmapFont(Texture2D texture, int glyphWidth, int glyphHeight, int firstChar) {
+	BitmapFont font = { 0 };
+	font.texture = texture;
+	font.glyphWidth = glyphWidth;
+	font.glyphHeight = glyphHeight;
+
+	bool vertical = texture.height > texture.width;
+	font.glyphCount = vertical ? texture.height / glyphHeight : texture.width / glyphWidth;
+	if (font.glyphCount > BITMAPFONT_MAX_GLYPHS) font.glyphCount = BITMAPFONT_MAX_GLYPHS;
+
+	for (int i = 0; i < font.glyphCount; i++) {
+		font.glyphs[i].source = vertical ?
+			(Rectangle) { 0, i * glyphHeight, glyphWidth, glyphHeight } :
+			(Rectangle) { i * glyphWidth, 0, glyphWidth, glyphHeight };
+		font.glyphs[i].advance = glyphWidth;
+	}
+
+	int blank = (' ' >= firstChar && ' ' < firstChar + font.glyphCount) ? ' ' - firstChar : 0;
+	for (int c = 0; c < 256; c++) {
+		int g = c - firstChar;
+		font.map[c] = (g >= 0 && g < font.glyphCount) ? g : blank;
+	}
+
+	return font;
+}
+
+static BitmapText LoadBitmapText(const BitmapFont *font, const char *text) {
+	BitmapText t = { 0 };
+	t.length = strlen(text);
+	t.glyphs = (unsigned char *)malloc(t.length > 0 ? t.length : 1);
+	if (t.glyphs == NULL) {
+		TraceLog(LOG_WARNING, "FONT: could not allocate a text of %i glyphs", t.length);
+		t.length = 0;
+		return t;
+	}
+	for (int i = 0; i < t.length; i++) t.glyphs[i] = font->map[(unsigned char)text[i]];
+	return t;
+}
+
+static void UnloadBitmapText(BitmapText *text) {
+	free(text->glyphs);
+	text->glyphs = NULL;
+	text->length = 0;
+}
+
+static Rectangle GetBitmapGlyphSource(const BitmapFont *font, unsigned char glyph) {
+	return font->glyphs[glyph].source;
+}
+
+// Lays out glyphs [first, first + count) on a line starting at 'position'. Glyphs whose left edge is not
+// strictly between minX and maxX are culled. Returns the number of quads written.
+static int LayoutBitmapText(const BitmapFont *font, const BitmapText *text, int first, int count,
+	Vector2 position, Vector2 scale, float minX, float maxX, GlyphQuad *quads) {
+	if (first < 0) { count += first; first = 0; }
+	if (first + count > text->length) count = text->length - first;
+
+	int n = 0;
+	float x = position.x;
+	for (int i = first; i < first + count; i++) {
+		const BitmapGlyph *g = &font->glyphs[text->glyphs[i]];
+		if (x > minX && x < maxX) {
+			quads[n].source = g->source;
+			quads[n].dest = (Rectangle) { x, position.y, g->source.width * scale.x, g->source.height * scale.y };
+			quads[n].index = i;
+			n++;
+		}
+		x += g->advance * scale.x;
+	}
+	return n;
+}
+
+// First glyph of a run of fixed advance text that can be visible past 'minX'
+static int BitmapTextFirstVisible(const BitmapFont *font, float positionX, float minX) {
+	int first = (int)((minX - positionX) / font->glyphWidth);
+	return first > 0 ? first : 0;
+}
+
+static void DrawGlyphQuads(const BitmapFont *font, const GlyphQuad *quads, int count, Color tint) {
+	for (int i = 0; i < count; i++) {
+		DrawTexturePro(font->texture, quads[i].source, quads[i].dest, (Vector2) {0}, 0, tint);
+	}
+}
+
+#endif
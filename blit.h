@@ -0,0 +1,203 @@
+#ifndef __BLIT_H__
+#define __BLIT_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <math.h>
+#include <stdbool.h>
+#include "pixelfx.h"
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------
+// CPU blitter
+// Draws a rectangle of an RGBA image into a pixel buffer, scaled with nearest sampling (pixel centres), tinted
+// and either copied or alpha blended, for composing the demo's sprites without a GPU. Every product is rounded
+// to 0..255 with the same integer division by 255, so the SSE2 (4 pixels) and AVX2 (8 pixels) rows give the
+// scalar reference's result to the bit. Unscaled rows load the source directly, scaled rows gather it.
+// 'from' must lie inside the source.
+//
+// BlitKernel() is a pixel kernel, so a large blit can run on the pixel pool; Blit() runs it on this thread.
+
+typedef enum { BLIT_COPY = 0, BLIT_ALPHA } BlitMode;
+
+typedef struct BlitSource {
+	const Color *pixels;
+	int width;
+	int height;
+} BlitSource;
+
+// One destination row: 'count' pixels from source x (u + i*du) >> 16, 16.16 fixed point
+typedef void (*BlitRow)(Color *dst, const Color *src, int count, int u, int du, Color tint, BlitMode mode);
+
+typedef struct BlitParams {
+	BlitSource source;
+	Color tint;
+	BlitMode mode;
+	BlitRow row;
+	int x0, y0, x1, y1;     // destination, clipped
+	int u0, du;             // source x of x0 and step, 16.16
+	int v0, dv;             // source y of y0 and step
+} BlitParams;
+
+// Rounded x/255 of x + 128, exact for x up to 255*255
+static inline unsigned char BlitDiv255(unsigned int v) {
+	return (unsigned char)((v + (v >> 8)) >> 8);
+}
+
+// Scalar reference, also used for the tail of each row
+static void BlitRowScalar(Color *dst, const Color *src, int count, int u, int du, Color tint, BlitMode mode) {
+	bool tinted = (tint.r & tint.g & tint.b & tint.a) != 255;
+
+	for (int i = 0; i < count; i++) {
+		Color s = src[(u + i*du) >> 16];
+		if (tinted) {
+			s.r = BlitDiv255(s.r*tint.r + 128);
+			s.g = BlitDiv255(s.g*tint.g + 128);
+			s.b = BlitDiv255(s.b*tint.b + 128);
+			s.a = BlitDiv255(s.a*tint.a + 128);
+		}
+		if (mode == BLIT_ALPHA) {
+			Color d = dst[i];
+			unsigned int a = s.a, inverse = 255 - a;
+			s.r = BlitDiv255(s.r*a + d.r*inverse + 128);
+			s.g = BlitDiv255(s.g*a + d.g*inverse + 128);
+			s.b = BlitDiv255(s.b*a + d.b*inverse + 128);
+			s.a = BlitDiv255(s.a*255 + d.a*inverse + 128);     // a + d.a*(1 - a)
+		}
+		dst[i] = s;
+	}
+}
+
+#if defined(__SSE2__)
+static inline __m128i BlitDiv255x8(__m128i v) {
+	return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+// 2 pixels as 16 bit channels: tint, then blend over the destination's
+static inline __m128i BlitPixels2(__m128i s, __m128i d, __m128i tint, bool tinted, BlitMode mode) {
+	__m128i round = _mm_set1_epi16(128), full = _mm_set1_epi16(255);
+	if (tinted) s = BlitDiv255x8(_mm_add_epi16(_mm_mullo_epi16(s, tint), round));
+	if (mode != BLIT_ALPHA) return s;
+
+	__m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i sourceFactor = _mm_or_si128(_mm_andnot_si128(alphaLanes, a), _mm_and_si128(alphaLanes, full));
+	__m128i sum = _mm_add_epi16(_mm_mullo_epi16(s, sourceFactor), _mm_mullo_epi16(d, _mm_sub_epi16(full, a)));
+	return BlitDiv255x8(_mm_add_epi16(sum, round));
+}
+
+static void BlitRowSse2(Color *dst, const Color *src, int count, int u, int du, Color tint, BlitMode mode) {
+	const int *source = (const int *)src;
+	bool tinted = (tint.r & tint.g & tint.b & tint.a) != 255;
+	__m128i zero = _mm_setzero_si128();
+	__m128i tint16 = _mm_set_epi16(tint.a, tint.b, tint.g, tint.r, tint.a, tint.b, tint.g, tint.r);
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		int x = u + i*du;
+		__m128i s = (du == 1 << 16) ? _mm_loadu_si128((const __m128i *)(source + (x >> 16)))
+			: _mm_set_epi32(source[(x + 3*du) >> 16], source[(x + 2*du) >> 16], source[(x + du) >> 16], source[x >> 16]);
+		__m128i d = (mode == BLIT_ALPHA) ? _mm_loadu_si128((const __m128i *)(dst + i)) : zero;
+
+		__m128i lo = BlitPixels2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), tint16, tinted, mode);
+		__m128i hi = BlitPixels2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), tint16, tinted, mode);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	BlitRowScalar(dst + i, src, count - i, u + i*du, du, tint, mode);
+}
+#endif
+
+#if defined(__AVX2__)
+static inline __m256i BlitDiv255x16(__m256i v) {
+	return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+}
+
+static inline __m256i BlitPixels4(__m256i s, __m256i d, __m256i tint, bool tinted, BlitMode mode) {
+	__m256i round = _mm256_set1_epi16(128), full = _mm256_set1_epi16(255);
+	if (tinted) s = BlitDiv255x16(_mm256_add_epi16(_mm256_mullo_epi16(s, tint), round));
+	if (mode != BLIT_ALPHA) return s;
+
+	__m256i alphaLanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m256i sourceFactor = _mm256_blendv_epi8(a, full, alphaLanes);
+	__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(s, sourceFactor), _mm256_mullo_epi16(d, _mm256_sub_epi16(full, a)));
+	return BlitDiv255x16(_mm256_add_epi16(sum, round));
+}
+
+static void BlitRowAvx2(Color *dst, const Color *src, int count, int u, int du, Color tint, BlitMode mode) {
+	const int *source = (const int *)src;
+	bool tinted = (tint.r & tint.g & tint.b & tint.a) != 255;
+	__m256i zero = _mm256_setzero_si256();
+	__m256i tint16 = _mm256_set1_epi64x((long long)tint.a << 48 | (long long)tint.b << 32 | (long long)tint.g << 16 | tint.r);
+	__m256i steps = _mm256_mullo_epi32(_mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0), _mm256_set1_epi32(du));
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		int x = u + i*du;
+		__m256i s = (du == 1 << 16) ? _mm256_loadu_si256((const __m256i *)(source + (x >> 16)))
+			: _mm256_i32gather_epi32(source, _mm256_srli_epi32(_mm256_add_epi32(_mm256_set1_epi32(x), steps), 16), 4);
+		__m256i d = (mode == BLIT_ALPHA) ? _mm256_loadu_si256((const __m256i *)(dst + i)) : zero;
+
+		__m256i lo = BlitPixels4(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), tint16, tinted, mode);
+		__m256i hi = BlitPixels4(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), tint16, tinted, mode);
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+	BlitRowSse2(dst + i, src, count - i, u + i*du, du, tint, mode);     // sprites are narrow, the tail matters
+}
+#endif
+
+#if defined(__AVX2__)
+	#define BlitRowBest BlitRowAvx2
+#elif defined(__SSE2__)
+	#define BlitRowBest BlitRowSse2
+#else
+	#define BlitRowBest BlitRowScalar
+#endif
+
+// 'from' in source pixels, 'to' in destination pixels (rounded down); nothing to draw leaves x0 == x1
+static BlitParams PrepareBlit(const PixelBuffer *buffer, BlitSource source, Rectangle from, Rectangle to, Color tint, BlitMode mode) {
+	BlitParams p = { source, tint, mode, BlitRowBest };
+	int x = (int)floorf(to.x), y = (int)floorf(to.y), width = (int)to.width, height = (int)to.height;
+	if (width <= 0 || height <= 0 || from.width < 1 || from.height < 1) return p;
+
+	// Pixel centres: destination pixel i samples source from + (i + 0.5)*step, never past the last column
+	p.du = (int)(from.width*65536.0f)/width;
+	p.dv = (int)(from.height*65536.0f)/height;
+	p.u0 = (int)from.x*65536 + p.du/2;
+	p.v0 = (int)from.y*65536 + p.dv/2;
+
+	p.x0 = x < 0 ? 0 : x;
+	p.y0 = y < 0 ? 0 : y;
+	p.x1 = x + width > buffer->width ? buffer->width : x + width;
+	p.y1 = y + height > buffer->height ? buffer->height : y + height;
+	if (p.x1 <= p.x0 || p.y1 <= p.y0) { p.x1 = p.x0; p.y1 = p.y0; return p; }
+
+	p.u0 += (p.x0 - x)*p.du;
+	p.v0 += (p.y0 - y)*p.dv;
+	return p;
+}
+
+static void BlitKernel(PixelBuffer *buffer, int y0, int y1, const void *params) {
+	const BlitParams *p = (const BlitParams *)params;
+	if (y0 < p->y0) y0 = p->y0;
+	if (y1 > p->y1) y1 = p->y1;
+
+	for (int y = y0; y < y1; y++) {
+		const Color *src = p->source.pixels + (size_t)((p->v0 + (y - p->y0)*p->dv) >> 16)*p->source.width;
+		p->row(buffer->pixels + (size_t)y*buffer->width + p->x0, src, p->x1 - p->x0, p->u0, p->du, p->tint, p->mode);
+	}
+}
+
+static void Blit(PixelBuffer *buffer, BlitSource source, Rectangle from, Rectangle to, Color tint, BlitMode mode) {
+	BlitParams p = PrepareBlit(buffer, source, from, to, tint, mode);
+	BlitKernel(buffer, p.y0, p.y1, &p);
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "qoi.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Frame capture
+// Copies a render texture into a fixed ring of staging buffers and encodes them to QOI or PNG on worker
+// threads, so the render thread only pays for the copy. With a golden directory, frames are compared against
+// the QOI files of the same name instead, and only the mismatching ones are written. With desktop GL the copy
+// goes through a pixel buffer object and is read back one frame later, without waiting for the GPU; otherwise,
+// or with CAPTURE_NO_PBO defined, the pixels are read synchronously. When every slot is busy the frame is
+// dropped and counted, memory never grows past the ring; golden runs wait for a slot instead, so no frame goes
+// unchecked.
+
+#if defined(__linux__) && !defined(CAPTURE_NO_PBO)
+	#define CAPTURE_PBO
+	#define GL_GLEXT_PROTOTYPES
+	#include <GL/gl.h>
+	#include <GL/glext.h>
+#endif
+
+#define CAPTURE_MAX_SLOTS 16
+#define CAPTURE_MAX_WORKERS 8
+
+typedef enum { CAPTURE_QOI = 0, CAPTURE_PNG } CaptureFormat;
+
+typedef enum { CAPTURE_FREE = 0, CAPTURE_READING, CAPTURE_QUEUED, CAPTURE_ENCODING } CaptureState;
+
+typedef struct CaptureSlot {
+	CaptureState state;
+	int frame;
+	unsigned char *pixels;          // width*height RGBA, bottom row first as GL reads it
+	unsigned int pbo;
+} CaptureSlot;
+
+typedef struct CaptureStats {
+	int requested;                  // frames due for capture
+	int captured;                   // frames copied into a slot
+	int dropped;                    // frames skipped because every slot was busy
+	int encoded;
+	int inFlight;                   // slots not free right now
+	int peakInFlight;
+	double copyMs;                  // render thread time spent copying, total
+	double encodeMs;                // worker time spent encoding, total
+	int compared;                   // frames checked against a golden
+	int mismatched;                 // of which differed, or had no golden
+} CaptureStats;
+
+typedef struct CaptureConfig {
+	int every;                      // 0 when not capturing from the start
+	int slots;
+	int workers;
+	const char *directory;
+	CaptureFormat format;
+	const char *golden;             // directory of golden QOI frames, NULL when not comparing
+	int tolerance;                  // channel difference still counted as a match
+} CaptureConfig;
+
+typedef struct FrameCapture {
+	int width;
+	int height;
+	CaptureConfig config;
+	bool usePbo;
+
+	int slotCount;
+	CaptureSlot slots[CAPTURE_MAX_SLOTS];
+
+	int workerCount;
+	pthread_t workers[CAPTURE_MAX_WORKERS];
+	pthread_mutex_t mutex;
+	pthread_cond_t queued;
+	pthread_cond_t idle;
+	bool quit;
+
+	CaptureStats stats;
+} FrameCapture;
+
+//     --capture N          capture every Nth frame from the start (F4 toggles capture either way)
+//     --capture-dir dir    where the captured frames go, "capture" by default
+//     --capture-slots n    staging buffers, 4 by default
+//     --capture-format f   qoi (default) or png
+//     --golden dir         compare with the frames in dir, the exit code tells if any differed
+//     --golden-tolerance n largest channel difference still matching, 0 by default
+static CaptureConfig ParseCaptureArgs(int argc, char **argv) {
+	CaptureConfig config = { 0, 4, 0, "capture", CAPTURE_QOI, NULL, 0 };
+
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--capture") == 0) config.every = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--capture-dir") == 0) config.directory = argv[++i];
+		else if (strcmp(argv[i], "--capture-slots") == 0) config.slots = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--capture-format") == 0) config.format = (strcmp(argv[++i], "png") == 0) ? CAPTURE_PNG : CAPTURE_QOI;
+		else if (strcmp(argv[i], "--golden") == 0) config.golden = argv[++i];
+		else if (strcmp(argv[i], "--golden-tolerance") == 0) config.tolerance = atoi(argv[++i]);
+	}
+	if (config.every < 0) config.every = 0;
+	if (config.golden != NULL && config.every == 0) config.every = 1;
+	return config;
+}
+
+static double CaptureNow(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1000.0 + ts.tv_nsec*1e-6;
+}
+
+static void WriteCaptureFile(FrameCapture *capture, const Color *pixels, unsigned char *encoded, int frame) {
+	char fileName[512];
+
+	if (capture->config.format == CAPTURE_PNG) {
+		snprintf(fileName, sizeof(fileName), "%s/frame%06i.png", capture->config.directory, frame);
+		Image image = { (void *)pixels, capture->width, capture->height, 1, UNCOMPRESSED_R8G8B8A8 };
+		ExportImage(image, fileName);
+		return;
+	}
+
+	snprintf(fileName, sizeof(fileName), "%s/frame%06i.qoi", capture->config.directory, frame);
+	size_t size = EncodeQoi(pixels, capture->width, capture->height, encoded);
+	FILE *file = fopen(fileName, "wb");
+	if (file == NULL || fwrite(encoded, 1, size, file) != size) TraceLog(LOG_WARNING, "CAPTURE: could not write %s", fileName);
+	if (file != NULL) fclose(file);
+}
+
+static void *CaptureWorker(void *arg) {
+	FrameCapture *capture = (FrameCapture *)arg;
+	size_t stride = (size_t)capture->width*4;
+	unsigned char *flipped = (unsigned char *)malloc(stride*capture->height);
+	unsigned char *encoded = (unsigned char *)malloc(QoiMaxSize(capture->width, capture->height));
+	char fileName[512];
+
+	pthread_mutex_lock(&capture->mutex);
+	for (;;) {
+		// Oldest queued frame first
+		CaptureSlot *slot = NULL;
+		for (int i = 0; i < capture->slotCount; i++) {
+			CaptureSlot *s = &capture->slots[i];
+			if (s->state == CAPTURE_QUEUED && (slot == NULL || s->frame < slot->frame)) slot = s;
+		}
+		if (slot == NULL) {
+			if (capture->quit) break;
+			pthread_cond_wait(&capture->queued, &capture->mutex);
+			continue;
+		}
+		slot->state = CAPTURE_ENCODING;
+		pthread_mutex_unlock(&capture->mutex);
+
+		double start = CaptureNow();
+		for (int y = 0; y < capture->height; y++) {
+			memcpy(flipped + y*stride, slot->pixels + (capture->height - 1 - y)*stride, stride);
+		}
+
+		bool mismatch = false;
+		if (capture->config.golden != NULL) {
+			snprintf(fileName, sizeof(fileName), "%s/frame%06i.qoi", capture->config.golden, slot->frame);
+			QoiDiff diff = CompareQoiGolden((const Color *)flipped, capture->width, capture->height, fileName, capture->config.tolerance);
+			mismatch = !diff.loaded || diff.mismatched > 0;
+			if (!diff.loaded) TraceLog(LOG_WARNING, "CAPTURE: no golden for frame %i", slot->frame);
+			else if (mismatch) TraceLog(LOG_WARNING, "CAPTURE: frame %i differs from its golden, %i pixels, max delta %i", slot->frame, diff.mismatched, diff.maxDelta);
+		}
+		if (capture->config.golden == NULL || mismatch) WriteCaptureFile(capture, (const Color *)flipped, encoded, slot->frame);
+		double ms = CaptureNow() - start;
+
+		pthread_mutex_lock(&capture->mutex);
+		if (capture->config.golden != NULL) {
+			capture->stats.compared++;
+			if (mismatch) capture->stats.mismatched++;
+		}
+		slot->state = CAPTURE_FREE;
+		capture->stats.encoded++;
+		capture->stats.inFlight--;
+		capture->stats.encodeMs += ms;
+		pthread_cond_broadcast(&capture->idle);
+	}
+	pthread_mutex_unlock(&capture->mutex);
+
+	free(encoded);
+	free(flipped);
+	return NULL;
+}
+
+// Call after InitWindow(). slots <= 0 picks 4, workers <= 0 one per core but the render thread's, NULL when
+// not a single slot or encoder could be started
+static FrameCapture *LoadFrameCapture(int width, int height, CaptureConfig config) {
+	int slots = config.slots, workers = config.workers;
+	if (slots <= 0) slots = 4;
+	if (slots > CAPTURE_MAX_SLOTS) slots = CAPTURE_MAX_SLOTS;
+	if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	if (workers < 1) workers = 1;
+	if (workers > CAPTURE_MAX_WORKERS) workers = CAPTURE_MAX_WORKERS;
+
+	FrameCapture *capture = (FrameCapture *)calloc(1, sizeof(FrameCapture));
+	if (capture == NULL) {
+		TraceLog(LOG_WARNING, "CAPTURE: could not allocate the capture, frames are not captured");
+		return NULL;
+	}
+	capture->width = width;
+	capture->height = height;
+	capture->config = config;
+	if (capture->config.every < 1) capture->config.every = 1;
+
+	mkdir(config.directory, 0755);
+
+	// The ring is as long as the staging buffers that could be allocated
+	size_t size = (size_t)width*height*4;
+	for (int i = 0; i < slots; i++) {
+		capture->slots[i].pixels = (unsigned char *)malloc(size);
+		if (capture->slots[i].pixels == NULL) break;
+		capture->slotCount++;
+	}
+	if (capture->slotCount < slots) TraceLog(LOG_WARNING, "CAPTURE: could only allocate %i of %i slots", capture->slotCount, slots);
+	slots = capture->slotCount;
+
+	pthread_mutex_init(&capture->mutex, NULL);
+	pthread_cond_init(&capture->queued, NULL);
+	pthread_cond_init(&capture->idle, NULL);
+	for (int i = 0; i < workers && slots > 0; i++) {
+		if (pthread_create(&capture->workers[i], NULL, CaptureWorker, capture) != 0) break;
+		capture->workerCount++;
+	}
+
+	// Without a slot or an encoder no frame would ever be written, and golden runs would wait forever
+	if (capture->workerCount == 0) {
+		TraceLog(LOG_WARNING, "CAPTURE: could not start the capture, frames are not captured");
+		for (int i = 0; i < slots; i++) free(capture->slots[i].pixels);
+		pthread_cond_destroy(&capture->idle);
+		pthread_cond_destroy(&capture->queued);
+		pthread_mutex_destroy(&capture->mutex);
+		free(capture);
+		return NULL;
+	}
+
+#if defined(CAPTURE_PBO)
+	int major = 0, minor = 0;
+	const char *version = (const char *)glGetString(GL_VERSION);
+	if (version != NULL) sscanf(version, "%d.%d", &major, &minor);
+
+	if (major >= 3) {
+		for (int i = 0; i < slots; i++) {
+			glGenBuffers(1, &capture->slots[i].pbo);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->slots[i].pbo);
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		capture->usePbo = true;
+	}
+#endif
+
+	TraceLog(LOG_INFO, "CAPTURE: every %i frames to %s as %s%s%s, %i slots of %i KB, %i encoders, %s", capture->config.every,
+		config.directory, config.format == CAPTURE_PNG ? "PNG" : "QOI", config.golden ? ", compared with " : "", config.golden ? config.golden : "", slots, (int)(size/1024), capture->workerCount, capture->usePbo ? "pixel buffer readback" : "synchronous readback");
+	return capture;
+}
+
+// Hands the frames read last time to the encoders
+static void ResolveFrameCapture(FrameCapture *capture) {
+#if defined(CAPTURE_PBO)
+	size_t size = (size_t)capture->width*capture->height*4;
+	bool queued = false;
+
+	for (int i = 0; i < capture->slotCount; i++) {
+		CaptureSlot *slot = &capture->slots[i];
+		if (slot->state != CAPTURE_READING) continue;
+
+		double start = CaptureNow();
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+		void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+		if (data != NULL) {
+			memcpy(slot->pixels, data, size);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		capture->stats.copyMs += CaptureNow() - start;
+
+		pthread_mutex_lock(&capture->mutex);
+		slot->state = CAPTURE_QUEUED;
+		pthread_mutex_unlock(&capture->mutex);
+		queued = true;
+	}
+	if (queued) pthread_cond_broadcast(&capture->queued);
+#endif
+}
+
+// Call once per frame after EndTextureMode(target)
+static void UpdateFrameCapture(FrameCapture *capture, RenderTexture2D target, int frame) {
+	ResolveFrameCapture(capture);
+	if (frame % capture->config.every != 0) return;
+
+	capture->stats.requested++;
+
+	pthread_mutex_lock(&capture->mutex);
+	CaptureSlot *slot = NULL;
+	for (;;) {
+		for (int i = 0; i < capture->slotCount; i++) {
+			if (capture->slots[i].state == CAPTURE_FREE) { slot = &capture->slots[i]; break; }
+		}
+		// A golden run checks every frame, it waits for the workers (read slots were queued above)
+		if (slot != NULL || capture->config.golden == NULL) break;
+		pthread_cond_wait(&capture->idle, &capture->mutex);
+	}
+	if (slot != NULL) {
+		slot->state = CAPTURE_READING;
+		slot->frame = frame;
+		capture->stats.inFlight++;
+		if (capture->stats.inFlight > capture->stats.peakInFlight) capture->stats.peakInFlight = capture->stats.inFlight;
+	} else {
+		capture->stats.dropped++;
+	}
+	pthread_mutex_unlock(&capture->mutex);
+	if (slot == NULL) return;
+
+	capture->stats.captured++;
+	double start = CaptureNow();
+
+#if defined(CAPTURE_PBO)
+	if (capture->usePbo) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, target.id);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+		glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		capture->stats.copyMs += CaptureNow() - start;
+		return;
+	}
+#endif
+
+	Image image = GetTextureData(target.texture);
+	if (image.data != NULL) memcpy(slot->pixels, image.data, (size_t)capture->width*capture->height*4);
+	UnloadImage(image);
+	capture->stats.copyMs += CaptureNow() - start;
+
+	pthread_mutex_lock(&capture->mutex);
+	slot->state = CAPTURE_QUEUED;
+	pthread_cond_broadcast(&capture->queued);
+	pthread_mutex_unlock(&capture->mutex);
+}
+
+// Encodes what is still queued, then stops the workers and returns the final stats
+static CaptureStats UnloadFrameCapture(FrameCapture *capture) {
+	ResolveFrameCapture(capture);
+
+	pthread_mutex_lock(&capture->mutex);
+	while (capture->stats.inFlight > 0) pthread_cond_wait(&capture->idle, &capture->mutex);
+	capture->quit = true;
+	pthread_cond_broadcast(&capture->queued);
+	pthread_mutex_unlock(&capture->mutex);
+
+	for (int i = 0; i < capture->workerCount; i++) pthread_join(capture->workers[i], NULL);
+
+	TraceLog(LOG_INFO, "CAPTURE: %i of %i frames captured, %i dropped, copy %.2f ms/frame, encode %.1f ms/frame",
+		capture->stats.captured, capture->stats.requested, capture->stats.dropped,
+		capture->stats.captured ? capture->stats.copyMs/capture->stats.captured : 0.0,
+		capture->stats.encoded ? capture->stats.encodeMs/capture->stats.encoded : 0.0);
+	if (capture->config.golden != NULL) {
+		TraceLog(capture->stats.mismatched ? LOG_WARNING : LOG_INFO, "CAPTURE: %i of %i frames differ from the goldens in %s",
+			capture->stats.mismatched, capture->stats.compared, capture->config.golden);
+	}
+	CaptureStats stats = capture->stats;
+
+	for (int i = 0; i < capture->slotCount; i++) {
+#if defined(CAPTURE_PBO)
+		if (capture->slots[i].pbo > 0) glDeleteBuffers(1, &capture->slots[i].pbo);
+#endif
+		free(capture->slots[i].pixels);
+	}
+	pthread_cond_destroy(&capture->idle);
+	pthread_cond_destroy(&capture->queued);
+	pthread_mutex_destroy(&capture->mutex);
+	free(capture);
+	return stats;
+}
+
+// Stats are read by the render thread while the workers update them
+static CaptureStats GetCaptureStats(FrameCapture *capture) {
+	pthread_mutex_lock(&capture->mutex);
+	CaptureStats stats = capture->stats;
+	pthread_mutex_unlock(&capture->mutex);
+	return stats;
+}
+
+#endif
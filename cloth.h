@@ -0,0 +1,272 @@
+#ifndef __CLOTH_H__
+#define __CLOTH_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "pixelfx.h"
+#include "effects.h"
+
+#if defined(__SSE__)
+	#include <xmmintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------
+// Cloth flag
+// The flag's glyph grid as a cloth: one particle per cell, pinned along the pole on the left, pulled by gravity
+// and a gusting wind, with Verlet integration and distance constraints between neighbours. Particles are stored
+// as structures of arrays (x, y, z rows padded to 4 floats). Each iteration relaxes the horizontal constraints
+// row by row (even pairs, then odd pairs, within one SSE register each) and the vertical ones between pairs of
+// rows, even rows then odd rows, 4 columns at a time. Passes only touch disjoint particles, so row bands run on
+// the pixel pool threads and the result does not depend on the thread count.
+//
+// The particles drive the same cells as the sine flag (EmitFlagCells); z only shades them. F6 switches.
+
+#define CLOTH_STEP (1.0f/60.0f)         // fixed time step
+#define CLOTH_MAX_STEPS 2               // per frame, longer frames drop the rest
+#define CLOTH_ITERATIONS 8
+#define CLOTH_DAMPING 0.99f
+
+typedef struct ClothFlag {
+	int columns;
+	int rows;
+	int stride;             // floats per row, multiple of 4
+	float spacing;          // rest length, the cell size
+	float *x, *y, *z;       // positions
+	float *px, *py, *pz;    // positions one step earlier
+	float *w;               // inverse mass, 0 along the pole
+	float *windColumn;      // gust of the step per column
+	Vector2 origin;         // top of the pole
+	float time;
+	float accumulator;
+	int iterations;
+	float gravity;          // per step squared
+	float wind;
+	float gust;
+} ClothFlag;
+
+// A flag of the sine flag's grid hanging from the same place, x is NULL when it could not be allocated
+static ClothFlag LoadClothFlag(int columns, int rows, float spacing, float screenWidth) {
+	ClothFlag cloth = { columns, rows, (columns + 3) & ~3, spacing };
+	size_t plane = (size_t)rows*cloth.stride;
+	float *memory = (float *)aligned_alloc(32, ((7*plane + cloth.stride)*sizeof(float) + 31) & ~(size_t)31);
+	if (memory == NULL) {
+		TraceLog(LOG_WARNING, "CLOTH: could not allocate a %ix%i cloth", columns, rows);
+		return (ClothFlag) { 0 };
+	}
+	memset(memory, 0, (7*plane + cloth.stride)*sizeof(float));
+	cloth.x = memory;
+	cloth.y = memory + plane;
+	cloth.z = memory + 2*plane;
+	cloth.px = memory + 3*plane;
+	cloth.py = memory + 4*plane;
+	cloth.pz = memory + 5*plane;
+	cloth.w = memory + 6*plane;
+	cloth.windColumn = memory + 7*plane;
+	cloth.origin = (Vector2) { (int)((screenWidth - (columns + 1)*spacing)*0.5), 5*spacing };
+	cloth.iterations = CLOTH_ITERATIONS;
+	cloth.gravity = 0.004f*spacing;
+	cloth.wind = 0.012f*spacing;
+	cloth.gust = 0.03f*spacing;
+
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < columns; c++) {
+			size_t i = (size_t)r*cloth.stride + c;
+			cloth.x[i] = cloth.px[i] = cloth.origin.x + c*spacing;
+			cloth.y[i] = cloth.py[i] = cloth.origin.y + r*spacing;
+			cloth.w[i] = (c == 0) ? 0.0f : 1.0f;
+		}
+	}
+	return cloth;
+}
+
+static void UnloadClothFlag(ClothFlag *cloth) {
+	free(cloth->x);
+	cloth->x = NULL;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Solver passes, run as pixel kernels over a buffer with one "pixel row" per particle row or row pair
+
+typedef struct ClothPass {
+	ClothFlag *cloth;
+	int parity;
+} ClothPass;
+
+static inline void ClothPairScalar(ClothFlag *cloth, size_t i, size_t j) {
+	float dx = cloth->x[j] - cloth->x[i], dy = cloth->y[j] - cloth->y[i], dz = cloth->z[j] - cloth->z[i];
+	float length = sqrtf(dx*dx + dy*dy + dz*dz);
+	float weights = cloth->w[i] + cloth->w[j];
+	if (length < 1e-6f || weights == 0.0f) return;
+	float s = (length - cloth->spacing)/(length*weights);
+	cloth->x[i] += cloth->w[i]*s*dx; cloth->y[i] += cloth->w[i]*s*dy; cloth->z[i] += cloth->w[i]*s*dz;
+	cloth->x[j] -= cloth->w[j]*s*dx; cloth->y[j] -= cloth->w[j]*s*dy; cloth->z[j] -= cloth->w[j]*s*dz;
+}
+
+// Verlet step of rows y0..y1: gravity down, wind along x, gusts along z travelling down the flag
+static void ClothIntegrateKernel(PixelBuffer *buffer, int y0, int y1, const void *params) {
+	ClothFlag *cloth = ((const ClothPass *)params)->cloth;
+	(void)buffer;
+
+	for (int r = y0; r < y1; r++) {
+		size_t row = (size_t)r*cloth->stride;
+		float gustRow = 0.3f*cloth->gust*sinf(cloth->time*2.3f + r*0.21f);
+		int c = 0;
+
+#if defined(__SSE__)
+		__m128 damping = _mm_set1_ps(CLOTH_DAMPING), gravity = _mm_set1_ps(cloth->gravity), wind = _mm_set1_ps(cloth->wind), gust = _mm_set1_ps(gustRow);
+		for (; c + 4 <= cloth->columns; c += 4) {
+			size_t i = row + c;
+			__m128 w = _mm_load_ps(cloth->w + i);
+			__m128 x = _mm_load_ps(cloth->x + i), y = _mm_load_ps(cloth->y + i), z = _mm_load_ps(cloth->z + i);
+			__m128 vx = _mm_mul_ps(_mm_sub_ps(x, _mm_load_ps(cloth->px + i)), damping);
+			__m128 vy = _mm_mul_ps(_mm_sub_ps(y, _mm_load_ps(cloth->py + i)), damping);
+			__m128 vz = _mm_mul_ps(_mm_sub_ps(z, _mm_load_ps(cloth->pz + i)), damping);
+			_mm_store_ps(cloth->px + i, x);
+			_mm_store_ps(cloth->py + i, y);
+			_mm_store_ps(cloth->pz + i, z);
+			__m128 az = _mm_add_ps(_mm_load_ps(cloth->windColumn + c), gust);
+			_mm_store_ps(cloth->x + i, _mm_add_ps(x, _mm_mul_ps(w, _mm_add_ps(vx, wind))));
+			_mm_store_ps(cloth->y + i, _mm_add_ps(y, _mm_mul_ps(w, _mm_add_ps(vy, gravity))));
+			_mm_store_ps(cloth->z + i, _mm_add_ps(z, _mm_mul_ps(w, _mm_add_ps(vz, az))));
+		}
+#endif
+
+		for (; c < cloth->columns; c++) {
+			size_t i = row + c;
+			float vx = (cloth->x[i] - cloth->px[i])*CLOTH_DAMPING, vy = (cloth->y[i] - cloth->py[i])*CLOTH_DAMPING, vz = (cloth->z[i] - cloth->pz[i])*CLOTH_DAMPING;
+			cloth->px[i] = cloth->x[i];
+			cloth->py[i] = cloth->y[i];
+			cloth->pz[i] = cloth->z[i];
+			cloth->x[i] += cloth->w[i]*(vx + cloth->wind);
+			cloth->y[i] += cloth->w[i]*(vy + cloth->gravity);
+			cloth->z[i] += cloth->w[i]*(vz + cloth->windColumn[c] + gustRow);
+		}
+	}
+}
+
+#if defined(__SSE__)
+// Pairs (0,1) and (2,3) of the 4 particles from i, each pair's correction computed in both of its lanes
+static inline void ClothPairs4(ClothFlag *cloth, size_t i, __m128 rest, __m128 sign) {
+	__m128 x = _mm_loadu_ps(cloth->x + i), y = _mm_loadu_ps(cloth->y + i), z = _mm_loadu_ps(cloth->z + i), w = _mm_loadu_ps(cloth->w + i);
+	__m128 dx = _mm_sub_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1)), _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0)));
+	__m128 dy = _mm_sub_ps(_mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1)), _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0)));
+	__m128 dz = _mm_sub_ps(_mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 3, 1, 1)), _mm_shuffle_ps(z, z, _MM_SHUFFLE(2, 2, 0, 0)));
+	__m128 weights = _mm_add_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1)), _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0)));
+
+	__m128 length = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz))), _mm_set1_ps(1e-6f));
+	__m128 s = _mm_div_ps(_mm_sub_ps(length, rest), _mm_mul_ps(length, _mm_max_ps(weights, _mm_set1_ps(1e-6f))));
+	s = _mm_mul_ps(_mm_mul_ps(s, w), sign);     // + for the first of a pair, - for the second
+
+	_mm_storeu_ps(cloth->x + i, _mm_add_ps(x, _mm_mul_ps(s, dx)));
+	_mm_storeu_ps(cloth->y + i, _mm_add_ps(y, _mm_mul_ps(s, dy)));
+	_mm_storeu_ps(cloth->z + i, _mm_add_ps(z, _mm_mul_ps(s, dz)));
+}
+#endif
+
+// Horizontal constraints of rows y0..y1, even pairs then odd pairs
+static void ClothRowKernel(PixelBuffer *buffer, int y0, int y1, const void *params) {
+	ClothFlag *cloth = ((const ClothPass *)params)->cloth;
+	(void)buffer;
+
+	for (int r = y0; r < y1; r++) {
+		size_t row = (size_t)r*cloth->stride;
+		for (int parity = 0; parity < 2; parity++) {
+			int c = parity;
+#if defined(__SSE__)
+			__m128 rest = _mm_set1_ps(cloth->spacing), sign = _mm_set_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+			for (; c + 4 <= cloth->columns; c += 4) ClothPairs4(cloth, row + c, rest, sign);
+#endif
+			for (; c + 1 < cloth->columns; c += 2) ClothPairScalar(cloth, row + c, row + c + 1);
+		}
+	}
+}
+
+// Vertical constraints between rows 2k + parity and 2k + parity + 1, for k in y0..y1
+static void ClothColumnKernel(PixelBuffer *buffer, int y0, int y1, const void *params) {
+	const ClothPass *pass = (const ClothPass *)params;
+	ClothFlag *cloth = pass->cloth;
+	(void)buffer;
+
+	for (int k = y0; k < y1; k++) {
+		size_t a = (size_t)(2*k + pass->parity)*cloth->stride, b = a + cloth->stride;
+		int c = 0;
+
+#if defined(__SSE__)
+		__m128 rest = _mm_set1_ps(cloth->spacing);
+		for (; c + 4 <= cloth->columns; c += 4) {
+			size_t i = a + c, j = b + c;
+			__m128 xi = _mm_load_ps(cloth->x + i), yi = _mm_load_ps(cloth->y + i), zi = _mm_load_ps(cloth->z + i), wi = _mm_load_ps(cloth->w + i);
+			__m128 xj = _mm_load_ps(cloth->x + j), yj = _mm_load_ps(cloth->y + j), zj = _mm_load_ps(cloth->z + j), wj = _mm_load_ps(cloth->w + j);
+			__m128 dx = _mm_sub_ps(xj, xi), dy = _mm_sub_ps(yj, yi), dz = _mm_sub_ps(zj, zi);
+
+			__m128 length = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz))), _mm_set1_ps(1e-6f));
+			__m128 s = _mm_div_ps(_mm_sub_ps(length, rest), _mm_mul_ps(length, _mm_max_ps(_mm_add_ps(wi, wj), _mm_set1_ps(1e-6f))));
+			__m128 si = _mm_mul_ps(s, wi), sj = _mm_mul_ps(s, wj);
+
+			_mm_store_ps(cloth->x + i, _mm_add_ps(xi, _mm_mul_ps(si, dx)));
+			_mm_store_ps(cloth->y + i, _mm_add_ps(yi, _mm_mul_ps(si, dy)));
+			_mm_store_ps(cloth->z + i, _mm_add_ps(zi, _mm_mul_ps(si, dz)));
+			_mm_store_ps(cloth->x + j, _mm_sub_ps(xj, _mm_mul_ps(sj, dx)));
+			_mm_store_ps(cloth->y + j, _mm_sub_ps(yj, _mm_mul_ps(sj, dy)));
+			_mm_store_ps(cloth->z + j, _mm_sub_ps(zj, _mm_mul_ps(sj, dz)));
+		}
+#endif
+
+		for (; c < cloth->columns; c++) ClothPairScalar(cloth, a + c, b + c);
+	}
+}
+
+// One fixed step: integrate, then relax rows and row pairs. Every pass ends before the next starts.
+static void SimulateClothFlag(ClothFlag *cloth, PixelPool *pool) {
+	for (int c = 0; c < cloth->columns; c++) cloth->windColumn[c] = cloth->gust*sinf(cloth->time*4.0f - c*0.35f);
+
+	ClothPass pass = { cloth, 0 };
+	PixelBuffer rows = { cloth->columns, cloth->rows, NULL };
+	RunPixelKernel(pool, &rows, ClothIntegrateKernel, &pass);
+	for (int i = 0; i < cloth->iterations; i++) {
+		RunPixelKernel(pool, &rows, ClothRowKernel, &pass);
+		for (int parity = 0; parity < 2; parity++) {
+			ClothPass pairs = { cloth, parity };
+			PixelBuffer rowPairs = { cloth->columns, (cloth->rows - parity)/2, NULL };
+			RunPixelKernel(pool, &rowPairs, ClothColumnKernel, &pairs);
+		}
+	}
+	cloth->time += CLOTH_STEP;
+}
+
+// Runs the fixed steps due after 'dt' seconds
+static void StepClothFlag(ClothFlag *cloth, PixelPool *pool, float dt) {
+	cloth->accumulator += dt;
+	int steps = 0;
+	while (cloth->accumulator >= CLOTH_STEP && steps < CLOTH_MAX_STEPS) {
+		SimulateClothFlag(cloth, pool);
+		cloth->accumulator -= CLOTH_STEP;
+		steps++;
+	}
+	if (steps == CLOTH_MAX_STEPS) cloth->accumulator = 0;
+}
+
+// The flag cells at the particles, shaded by how far the cloth swings out of the screen
+static void EmitClothFlag(QuadList *out, FrameArena *arena, const SineFlag *flag, const ClothFlag *cloth, LayerCache *layer) {
+	int cols = cloth->columns, rows = cloth->rows;
+	Vector2 *grid_pos = FRAME_ALLOC(arena, Vector2, cols*rows);
+	float *grid_shade = FRAME_ALLOC(arena, float, cols*rows);
+	float depth = 1.0f/(3.0f*cloth->spacing);
+
+	for (int y = 0; y < rows; y++) {
+		for (int x = 0; x < cols; x++) {
+			size_t i = (size_t)y*cloth->stride + x;
+			grid_pos[y*cols + x] = (Vector2) { cloth->x[i], cloth->y[i] };
+			float shade = cloth->z[i]*depth;
+			grid_shade[y*cols + x] = shade < -1.0f ? -1.0f : shade > 1.0f ? 1.0f : shade;
+		}
+	}
+	EmitFlagCells(out, flag, layer, grid_pos, NULL, grid_shade, NULL);
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef __COPPER_H__
+#define __COPPER_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdlib.h>
+#include "resources.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Copper list
+// Like the Amiga copper, every frame a list of per-scanline color changes is evaluated into one color per
+// line, uploaded to a 1xH texture and stretched over the screen with a single quad. Bars are painted from the
+// highest priority down and every scanline is written at most once, so the cost is O(scanlines) however many
+// bars overlap.
+
+#define COPPER_MAX_BARS 1024
+
+typedef struct CopperGradient {
+	const unsigned int *colors;     // R8G8B8A8 pixels, as in data.h
+	int length;
+	int stride;                     // distance between two rows of the source image
+} CopperGradient;
+
+typedef struct CopperBar {
+	float y;
+	float height;
+	int priority;                   // higher is in front, equal priorities: the later bar wins
+	CopperGradient gradient;
+} CopperBar;
+
+typedef struct CopperList {
+	int height;
+	int count;
+	CopperBar bars[COPPER_MAX_BARS];
+	unsigned int *lines;            // evaluated color of each scanline, transparent when no bar covers it
+	int *next;                      // next scanline not painted yet, path compressed
+	int *order;
+	Texture2D texture;
+} CopperList;
+
+// Rows [firstRow, firstRow + rows) of column 0 of a 'width' pixels wide image
+static CopperGradient CopperGradientFromImage(const void *data, int width, int firstRow, int rows) {
+	return (CopperGradient) { (const unsigned int *)data + firstRow*width, rows, width };
+}
+
+// NULL when it could not be allocated
+static CopperList *LoadCopperList(int height) {
+	CopperList *list = (CopperList *)calloc(1, sizeof(CopperList));
+	if (list == NULL) return NULL;
+	list->height = height;
+	list->lines = (unsigned int *)calloc(height, sizeof(unsigned int));
+	list->next = (int *)malloc((height + 1)*sizeof(int));
+	list->order = (int *)malloc(COPPER_MAX_BARS*sizeof(int));
+	if (list->lines == NULL || list->next == NULL || list->order == NULL) {
+		TraceLog(LOG_WARNING, "COPPER: could not allocate a copper list of %i lines", height);
+		free(list->order);
+		free(list->next);
+		free(list->lines);
+		free(list);
+		return NULL;
+	}
+
+	Image image = { list->lines, 1, height, 1, UNCOMPRESSED_R8G8B8A8 };
+	list->texture = LoadTrackedTexture(image, "copper list");
+	SetTextureFilter(list->texture, FILTER_POINT);
+	return list;
+}
+
+static void UnloadCopperList(CopperList *list) {
+	UnloadTrackedTexture(list->texture);
+	free(list->order);
+	free(list->next);
+	free(list->lines);
+	free(list);
+}
+
+static void ClearCopperList(CopperList *list) {
+	list->count = 0;
+}
+
+static void AddCopperBar(CopperList *list, float y, float height, int priority, CopperGradient gradient) {
+	if (list->count == COPPER_MAX_BARS) return;
+	list->bars[list->count++] = (CopperBar) { y, height, priority, gradient };
+}
+
+static int CopperNextFree(int *next, int line) {
+	int root = line;
+	while (next[root] != root) root = next[root];
+	while (next[line] != root) {
+		int n = next[line];
+		next[line] = root;
+		line = n;
+	}
+	return root;
+}
+
+static CopperList *copperSortList;
+
+static int CompareCopperBars(const void *a, const void *b) {
+	const CopperBar *ba = &copperSortList->bars[*(const int *)a];
+	const CopperBar *bb = &copperSortList->bars[*(const int *)b];
+	if (ba->priority != bb->priority) return bb->priority - ba->priority;
+	return *(const int *)b - *(const int *)a;
+}
+
+// Evaluates the list into one color per scanline and uploads it
+static void UpdateCopperList(CopperList *list) {
+	int h = list->height;
+
+	for (int i = 0; i < list->count; i++) list->order[i] = i;
+	copperSortList = list;
+	qsort(list->order, list->count, sizeof(int), CompareCopperBars);
+
+	for (int i = 0; i <= h; i++) list->next[i] = i;
+	for (int i = 0; i < h; i++) list->lines[i] = 0;
+
+	for (int k = 0; k < list->count; k++) {
+		const CopperBar *bar = &list->bars[list->order[k]];
+		if (bar->height <= 0 || bar->gradient.length <= 0) continue;
+
+		int y0 = (int)bar->y;
+		int y1 = (int)(bar->y + bar->height);
+		if (y0 < 0) y0 = 0;
+		if (y1 > h) y1 = h;
+		if (y0 >= y1) continue;
+
+		float step = bar->gradient.length/bar->height;
+		for (int line = CopperNextFree(list->next, y0); line < y1; line = CopperNextFree(list->next, line)) {
+			int g = (int)((line - bar->y)*step);
+			if (g >= bar->gradient.length) g = bar->gradient.length - 1;
+			list->lines[line] = bar->gradient.colors[g*bar->gradient.stride];
+			list->next[line] = line + 1;
+		}
+	}
+
+	UpdateTexture(list->texture, list->lines);
+}
+
+static void DrawCopperList(CopperList *list, Rectangle dest) {
+	DrawTexturePro(list->texture, (Rectangle) { 0, 0, 1, list->height }, dest, (Vector2) {0}, 0, WHITE);
+}
+
+#endif
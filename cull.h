@@ -0,0 +1,139 @@
+#ifndef __CULL_H__
+#define __CULL_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include "arena.h"
+#include "effects.h"
+#include "sprites.h"
+
+#if defined(__SSE__)
+	#include <xmmintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------
+// Culling
+// Drops the quads and sprites that fall completely outside the frame buffer before they are queued or
+// drawn. Bounds go to structure-of-arrays scratch in the frame arena and are tested four at a time, then
+// the list is compacted in place, keeping the order. Each effect counts what it drew and what was culled.
+
+typedef enum { CULL_STARS = 0, CULL_COPPER, CULL_LOGO, CULL_FLAG, CULL_SCROLLER, CULL_SCROLLER2, CULL_EFFECTS } CullEffect;
+
+static const char *cullEffectNames[CULL_EFFECTS] = { "stars", "copper", "logo", "flag", "scroller", "scroller2" };
+
+typedef struct CullCounter {
+	int drawn;
+	int culled;
+} CullCounter;
+
+static CullCounter cullStats[CULL_EFFECTS] = { 0 };
+
+typedef struct CullBounds {
+	float *x0;
+	float *y0;
+	float *x1;
+	float *y1;
+} CullBounds;
+
+static CullBounds AllocCullBounds(FrameArena *arena, int count) {
+	return (CullBounds) { FRAME_ALLOC(arena, float, count), FRAME_ALLOC(arena, float, count),
+		FRAME_ALLOC(arena, float, count), FRAME_ALLOC(arena, float, count) };
+}
+
+// visible[i] is 1 when box i overlaps the view
+static void CullTest(const CullBounds *b, int count, Rectangle view, unsigned char *visible) {
+	float vx0 = view.x, vy0 = view.y, vx1 = view.x + view.width, vy1 = view.y + view.height;
+	int i = 0;
+
+#if defined(__SSE__)
+	__m128 left = _mm_set1_ps(vx0), top = _mm_set1_ps(vy0), right = _mm_set1_ps(vx1), bottom = _mm_set1_ps(vy1);
+	for (; i + 4 <= count; i += 4) {
+		__m128 in = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(b->x0 + i), right), _mm_cmpgt_ps(_mm_loadu_ps(b->x1 + i), left));
+		in = _mm_and_ps(in, _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(b->y0 + i), bottom), _mm_cmpgt_ps(_mm_loadu_ps(b->y1 + i), top)));
+		int mask = _mm_movemask_ps(in);
+		visible[i + 0] = mask & 1;
+		visible[i + 1] = (mask >> 1) & 1;
+		visible[i + 2] = (mask >> 2) & 1;
+		visible[i + 3] = (mask >> 3) & 1;
+	}
+#endif
+
+	for (; i < count; i++) visible[i] = b->x0[i] < vx1 && b->x1[i] > vx0 && b->y0[i] < vy1 && b->y1[i] > vy0;
+}
+
+static void CullQuads(QuadList *list, Rectangle view, CullEffect effect, FrameArena *arena) {
+	int n = list->count;
+	if (n == 0) return;
+
+	CullBounds b = AllocCullBounds(arena, n);
+	unsigned char *visible = FRAME_ALLOC(arena, unsigned char, n);
+
+	for (int i = 0; i < n; i++) {
+		Rectangle r = QuadBounds(&list->quads[i]);
+		b.x0[i] = r.x;
+		b.y0[i] = r.y;
+		b.x1[i] = r.x + r.width;
+		b.y1[i] = r.y + r.height;
+	}
+	CullTest(&b, n, view, visible);
+
+	int kept = 0;
+	for (int i = 0; i < n; i++) {
+		if (!visible[i]) continue;
+		if (kept != i) list->quads[kept] = list->quads[i];
+		kept++;
+	}
+	list->count = kept;
+	cullStats[effect].drawn += kept;
+	cullStats[effect].culled += n - kept;
+}
+
+// Call right after EndSpriteRange(), before anything else is pushed to the batch
+static void CullSpriteRange(SpriteRange *range, Rectangle view, CullEffect effect, FrameArena *arena) {
+	int n = range->count;
+	if (n == 0) return;
+
+	SpriteBatch *batch = range->batch;
+	SpriteInstance *instances = batch->instances + range->first;
+	float w = batch->texture.width, h = batch->texture.height;
+
+	CullBounds b = AllocCullBounds(arena, n);
+	unsigned char *visible = FRAME_ALLOC(arena, unsigned char, n);
+
+	for (int i = 0; i < n; i++) {
+		b.x0[i] = instances[i].x;
+		b.y0[i] = instances[i].y;
+		b.x1[i] = instances[i].x + w;
+		b.y1[i] = instances[i].y + h;
+	}
+	CullTest(&b, n, view, visible);
+
+	int kept = 0;
+	for (int i = 0; i < n; i++) {
+		if (!visible[i]) continue;
+		if (kept != i) instances[kept] = instances[i];
+		kept++;
+	}
+	range->count = kept;
+	batch->count = range->first + kept;
+	cullStats[effect].drawn += kept;
+	cullStats[effect].culled += n - kept;
+}
+
+static void ResetCullStats(void) {
+	for (int e = 0; e < CULL_EFFECTS; e++) cullStats[e] = (CullCounter) { 0 };
+}
+
+// One line for the overlay, drawn/culled per effect
+static const char *CullStatsText(void) {
+	static char text[256];
+	int length = snprintf(text, sizeof(text), "drawn/culled");
+	for (int e = 0; e < CULL_EFFECTS && length < (int)sizeof(text); e++) {
+		length += snprintf(text + length, sizeof(text) - length, " %s %i/%i", cullEffectNames[e], cullStats[e].drawn, cullStats[e].culled);
+	}
+	return text;
+}
+
+#endif
@@ -0,0 +1,323 @@
+#ifndef __EFFECTS_H__
+#define __EFFECTS_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <math.h>
+#include <stdlib.h>
+#include "rlgl.h"
+#include "arena.h"
+#include "bitmapfont.h"
+#include "layercache.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Effects
+// Each effect emits its quads into a QuadList (frame arena memory) instead of drawing them, and DrawQuads()
+// submits a list to raylib. Emitting needs no GL context, so the update and emit paths can be timed headless.
+
+typedef enum { QUAD_TEXTURE = 0, QUAD_SKEW, QUAD_RECTANGLE } QuadKind;
+
+typedef struct Quad {
+	int kind;
+	Texture2D texture;
+	Rectangle source;
+	Rectangle dest;
+	Vector2 skew;           // QUAD_SKEW only
+	float rotation;
+	Color tint;
+} Quad;
+
+typedef struct QuadList {
+	Quad *quads;
+	int count;
+	int capacity;
+} QuadList;
+
+static QuadList AllocQuadList(FrameArena *arena, int capacity) {
+	return (QuadList) { FRAME_ALLOC(arena, Quad, capacity), 0, capacity };
+}
+
+static Quad *PushQuad(QuadList *list) {
+	if (list->count == list->capacity) return NULL;
+	return &list->quads[list->count++];
+}
+
+static void PushTextureQuad(QuadList *list, Texture2D texture, Rectangle source, Rectangle dest, float rotation, Color tint) {
+	Quad *q = PushQuad(list);
+	if (q != NULL) *q = (Quad) { QUAD_TEXTURE, texture, source, dest, { 0, 0 }, rotation, tint };
+}
+
+static void PushSkewQuad(QuadList *list, Texture2D texture, Rectangle source, Rectangle dest, Vector2 skew, Color tint) {
+	Quad *q = PushQuad(list);
+	if (q != NULL) *q = (Quad) { QUAD_SKEW, texture, source, dest, skew, 0, tint };
+}
+
+static void PushRectangleQuad(QuadList *list, Rectangle dest, Color color) {
+	Quad *q = PushQuad(list);
+	if (q != NULL) *q = (Quad) { QUAD_RECTANGLE, { 0 }, { 0 }, dest, { 0, 0 }, 0, color };
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Skewed quads
+
+typedef struct SkewQuad {
+	Vector2 position[4];
+	Vector2 texcoord[4];
+} SkewQuad;
+
+// Corners of a skewed, rotated quad and their texture coordinates, in rlgl submission order
+static SkewQuad ComputeSkewQuad(Texture2D texture, Rectangle source, Rectangle dest, Vector2 skew, float rotation) {
+	SkewQuad q;
+	float width = (float)texture.width;
+	float height = (float)texture.height;
+
+	bool flipX = false;
+
+	if (source.width < 0) { flipX = true; source.width *= -1; }
+	if (source.height < 0) source.y -= source.height;
+
+	float u0 = source.x/width, u1 = (source.x + source.width)/width;
+	float v0 = source.y/height, v1 = (source.y + source.height)/height;
+	if (flipX) { float u = u0; u0 = u1; u1 = u; }
+
+	q.texcoord[0] = (Vector2) { u0, v0 };
+	q.texcoord[1] = (Vector2) { u0, v1 };
+	q.texcoord[2] = (Vector2) { u1, v1 };
+	q.texcoord[3] = (Vector2) { u1, v0 };
+
+	Vector2 corner[4] = {
+		{ 0.0f + skew.x, 0.0f },
+		{ 0.0f, dest.height },
+		{ dest.width, dest.height + skew.y },
+		{ dest.width + skew.x, 0.0f + skew.y }
+	};
+
+	float c = 1.0f, s = 0.0f;
+	if (rotation != 0.0f) { c = cosf(rotation*DEG2RAD); s = sinf(rotation*DEG2RAD); }
+
+	for (int i = 0; i < 4; i++) {
+		q.position[i].x = dest.x + corner[i].x*c - corner[i].y*s;
+		q.position[i].y = dest.y + corner[i].x*s + corner[i].y*c;
+	}
+	return q;
+}
+
+// Draw a part of a texture (defined by a rectangle) with 'pro' parameters
+// NOTE: origin is relative to destination rectangle size
+void DrawTextureProSK (Texture2D texture, Rectangle source, Rectangle dest, Vector2 skew, float rotation, Color tint)
+{
+    // Check if texture is valid
+    if (texture.id > 0)
+    {
+        SkewQuad q = ComputeSkewQuad(texture, source, dest, skew, rotation);
+
+        if (rlCheckBufferLimit(4)) rlglDraw();
+
+        rlEnableTexture(texture.id);
+
+        rlBegin(RL_QUADS);
+            rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+            rlNormal3f(0.0f, 0.0f, 1.0f);                          // Normal vector pointing towards viewer
+
+            for (int i = 0; i < 4; i++) {
+                rlTexCoord2f(q.texcoord[i].x, q.texcoord[i].y);
+                rlVertex2f(q.position[i].x, q.position[i].y);
+            }
+        rlEnd();
+
+        rlDisableTexture();
+    }
+}
+
+// Screen space bounding box, as drawn
+static Rectangle QuadBounds(const Quad *q) {
+	if (q->kind == QUAD_RECTANGLE) {
+		// DrawRectangle() takes integers
+		return (Rectangle) { (int)q->dest.x, (int)q->dest.y, (int)q->dest.width, (int)q->dest.height };
+	}
+
+	Vector2 corner[4];
+	if (q->kind == QUAD_SKEW) {
+		SkewQuad s = ComputeSkewQuad(q->texture, q->source, q->dest, q->skew, q->rotation);
+		for (int i = 0; i < 4; i++) corner[i] = s.position[i];
+	} else if (q->rotation != 0.0f) {
+		float c = cosf(q->rotation*DEG2RAD), s = sinf(q->rotation*DEG2RAD);
+		float w = q->dest.width, h = q->dest.height;
+		corner[0] = (Vector2) { q->dest.x, q->dest.y };
+		corner[1] = (Vector2) { q->dest.x - h*s, q->dest.y + h*c };
+		corner[2] = (Vector2) { q->dest.x + w*c - h*s, q->dest.y + w*s + h*c };
+		corner[3] = (Vector2) { q->dest.x + w*c, q->dest.y + w*s };
+	} else {
+		return q->dest;
+	}
+
+	float x0 = corner[0].x, y0 = corner[0].y, x1 = x0, y1 = y0;
+	for (int i = 1; i < 4; i++) {
+		x0 = fminf(x0, corner[i].x); x1 = fmaxf(x1, corner[i].x);
+		y0 = fminf(y0, corner[i].y); y1 = fmaxf(y1, corner[i].y);
+	}
+	return (Rectangle) { x0, y0, x1 - x0, y1 - y0 };
+}
+
+static void DrawQuads(const QuadList *list) {
+	for (int i = 0; i < list->count; i++) {
+		const Quad *q = &list->quads[i];
+		switch (q->kind) {
+			case QUAD_TEXTURE: DrawTexturePro(q->texture, q->source, q->dest, (Vector2) {0}, q->rotation, q->tint); break;
+			case QUAD_SKEW: DrawTextureProSK(q->texture, q->source, q->dest, q->skew, q->rotation, q->tint); break;
+			case QUAD_RECTANGLE: DrawRectangle(q->dest.x, q->dest.y, q->dest.width, q->dest.height, q->tint); break;
+		}
+	}
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Copper columns: 'columns' vertical strips across the screen, each crossing 'layers' bars (front bar last)
+static void EmitCopperColumns(QuadList *out, const Texture2D *copper, int textures, int columns, int layers,
+	float screenWidth, float rastsin, float rastoffset, float amp, float curve, float yOffset, float height) {
+	int scale = screenWidth / columns;
+
+	for(int x = 0; x < columns; x++) {
+		for(int y = layers - 1; y >= 0; y--) {
+			Texture2D t = copper[y % textures];
+			PushTextureQuad(out, t, (Rectangle) { 0, 0, t.width, t.height },
+				(Rectangle) {x*scale, (296/2) + sin(rastsin-rastoffset*(y*5)-(x*curve))*amp+yOffset, scale, height }, 0, WHITE);
+		}
+	}
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Logo: the texture cut in 'rows' horizontal strips (one per texel row at logo.height), each strip shifted
+// along a sine
+static void EmitLogoRows(QuadList *out, Texture2D logo, int rows, float xOffset, float yOffset, float sinparam, float curve) {
+	float strip = (float)logo.height/rows;
+
+	for(int i = 0; i < rows; i++) {
+		float y = i*strip;
+		PushTextureQuad(out, logo,
+			(Rectangle) { 0, y, logo.width, strip },
+			(Rectangle) { xOffset+sin(sinparam*0.1 + curve*y)*64 - 32, yOffset+y, logo.width, strip }, 0, WHITE);
+	}
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Sine flag: a grid of glyph cells from a cached layer, each cell over a colored rectangle
+
+typedef struct SineFlag {
+	int columns;
+	int rows;
+	int cellSize;
+	int glyphSize;          // of the cells in the cached layer, which repeats for larger grids
+	int span;               // glyphs along each side of a cell, 1 at full density
+	float sinx;
+	float siny;
+	float lastSiny;         // the previous frame's siny, whose rows the cells reach down to
+} SineFlag;
+
+// The cells at grid positions, each sized to reach its right and lower neighbours in 'grid_reach' (NULL for
+// grid_pos) and colored by its shade (-1..1); 'grid_overlap' (NULL for none) makes cells taller, 1.5px is
+// always added so rows leave no gaps
+static void EmitFlagCells(QuadList *out, const SineFlag *flag, LayerCache *layer, const Vector2 *grid_pos, const Vector2 *grid_reach,
+	const float *grid_shade, const float *grid_overlap) {
+	int cols = flag->columns, rows = flag->rows;
+	int cell_size = flag->cellSize;
+	int layerCols = layer->target.texture.width/flag->glyphSize;
+	int layerRows = layer->target.texture.height/flag->glyphSize;
+	float y_sin;
+	Vector2 cellsize;
+	if (grid_reach == NULL) grid_reach = grid_pos;
+
+	for(int y = 0; y < rows; y += 1) {
+		for(int x = 0; x < cols; x += 1) {
+			Vector2 pos = grid_pos[y*cols+x];
+			y_sin = grid_shade[y*cols+x];
+
+			if (x<(cols-1)) {cellsize.x = ((grid_reach[y*cols+x+1].x - pos.x));} else {cellsize.x = cell_size;};
+			if (y<(rows-1)) {cellsize.y = ((grid_reach[(y+1)*cols+x].y - pos.y) + (grid_overlap != NULL ? grid_overlap[y*cols+x] : 0)+1.5);} else {cellsize.y = cell_size;};
+
+			PushRectangleQuad(out, (Rectangle) {pos.x, pos.y, cellsize.x, cellsize.y}, (Color) { abs(y_sin*128.0)+127,abs(y_sin*128.0)+127,abs(y_sin*128.0),255 } );
+
+			PushTextureQuad(out, layer->target.texture,
+				LayerCacheSource(layer, (Rectangle) {((x*flag->span) % layerCols)*flag->glyphSize, ((y*flag->span) % layerRows)*flag->glyphSize, flag->span*flag->glyphSize, flag->span*flag->glyphSize }),
+				(Rectangle) {pos.x, pos.y , cellsize.x, cellsize.y},
+				0,(Color) {abs(y_sin*255.0),abs(y_sin*128.0),abs(y_sin*128.0),255});
+		}
+	}
+}
+
+// Cells spanning several glyphs sample the same wave at their first glyph, moving as far as glyph cells do
+static void EmitSineFlag(QuadList *out, FrameArena *arena, SineFlag *flag, LayerCache *layer, float screenWidth) {
+	int cols = flag->columns, rows = flag->rows;
+	int cell_size = flag->cellSize;
+	int span = flag->span;
+	float unit = (float)cell_size/span;
+
+	float x_offset = (int)((screenWidth-(cols*cell_size+unit))*0.5);
+	float y_offset = 5 * unit;
+	float x_sin, y_sin;
+	float oldsinx = flag->sinx;
+	float oldsiny = flag->siny;
+
+	// Grid positions first. Cells reach to where their neighbours were the frame before, as when the grid was
+	// drawn while being updated; the columns do not move, so only the rows below need the previous wave.
+	Vector2 *grid_pos = FRAME_ALLOC(arena, Vector2, cols*rows);
+	Vector2 *grid_last = FRAME_ALLOC(arena, Vector2, cols*rows);
+	float *grid_sin = FRAME_ALLOC(arena, float, cols*rows);
+	float *grid_cos = FRAME_ALLOC(arena, float, cols*rows);
+	float lastsiny = flag->lastSiny;
+
+	for(int y = 0; y < rows; y += 1) {
+		for(int x = 0; x < cols; x += 1) {
+			x_sin = sin(flag->sinx);
+			y_sin = sin(flag->siny);
+			grid_pos[y*cols+x].x = (x*span+x_sin)*unit + x_offset;
+			grid_pos[y*cols+x].y = (y*span+y_sin)*unit + y_offset;
+			grid_sin[y*cols+x] = y_sin;
+			flag->siny += 0.2*span;
+			grid_cos[y*cols+x] = cos(flag->siny);
+			grid_last[y*cols+x].x = grid_pos[y*cols+x].x;
+			grid_last[y*cols+x].y = (y*span+sin(lastsiny))*unit + y_offset;
+			lastsiny += 0.2*span;
+		}
+
+		flag->siny += 0.4*span + 0.2*span*cols*(span-1);  // this is the depth of the waves (skipped rows included)
+		lastsiny += 0.4*span + 0.2*span*cols*(span-1);
+		flag->sinx = oldsinx;
+	}
+
+	EmitFlagCells(out, flag, layer, grid_pos, grid_last, grid_sin, grid_cos);
+
+	flag->lastSiny = oldsiny;
+	flag->siny = oldsiny + 0.02;  // this is the vertical wave movement per frame
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Scrollers
+
+// Big scroller, one skewed glyph quad per visible character (32x32 glyphs drawn 32x64)
+static void EmitSkewScroller(QuadList *out, FrameArena *arena, const BitmapFont *font, const BitmapText *text,
+	float scrollX, float y, float screenWidth, Vector2 skew) {
+	int visible = screenWidth/font->glyphWidth + 4;
+	GlyphQuad *glyphs = FRAME_ALLOC(arena, GlyphQuad, visible);
+
+	int first = BitmapTextFirstVisible(font, scrollX, -font->glyphWidth);
+	int count = LayoutBitmapText(font, text, first, visible,
+		(Vector2) { scrollX + first*font->glyphWidth, y }, (Vector2) {1,2}, -font->glyphWidth, screenWidth + font->glyphWidth, glyphs);
+
+	for(int i = 0; i < count; i++) PushSkewQuad(out, font->texture, glyphs[i].source, glyphs[i].dest, skew, WHITE);
+}
+
+// Small scroller, every glyph bobbing along ySin and tilting by 'tilt' degrees per pixel of it (0 keeps
+// the glyphs upright, which also skips the rotation when drawing and culling)
+static void EmitWaveScroller(QuadList *out, FrameArena *arena, const BitmapFont *font, const BitmapText *text,
+	float x, float y, float screenWidth, const float *ySin, float tilt) {
+	GlyphQuad *glyphs = FRAME_ALLOC(arena, GlyphQuad, text->length);
+	int count = LayoutBitmapText(font, text, 0, text->length, (Vector2) { x + 1, y }, (Vector2) {1,1}, 16, screenWidth-16, glyphs);
+
+	for(int i = 0; i < count; i++) {
+		glyphs[i].dest.y += ySin[glyphs[i].index];
+		PushTextureQuad(out, font->texture, glyphs[i].source, glyphs[i].dest, ySin[glyphs[i].index]*tilt, WHITE);
+	}
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef __FRAMETIME_H__
+#define __FRAMETIME_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Frame time benchmark
+// Runs the whole scene for a fixed number of frames with vsync and the frame limiter off, in a hidden window,
+// and writes p50/p90/p99/max of the frame time and of each section of the frame to a JSON file:
+//
+//     ./demo --benchmark 1000 [--benchmark-warmup 60] [--benchmark-out frametime.json]
+//
+// The scene advances a fixed 1/60 s per frame from a fixed random seed, so every run draws the same frames
+// and only the time they take changes. Without a display, run it under xvfb-run: with no X server Mesa falls
+// back to llvmpipe, the software path. Sections are timed on the CPU; GPU work shows up where the driver
+// blocks, usually in present.
+
+typedef enum {
+	FRAME_SECTION_UPDATE = 0,       // music, scrolling, stars, culling, instance upload
+	FRAME_SECTION_PIXELS,           // CPU plasma and its texture upload
+	FRAME_SECTION_LAYERS,           // cached layer refresh
+	FRAME_SECTION_BACKGROUND,       // clear, plasma and copper
+	FRAME_SECTION_SPRITES,          // star sprite ranges
+	FRAME_SECTION_QUADS,            // logo, flag, copper bar and scrollers through the render queue
+	FRAME_SECTION_PRESENT,          // frame buffer to screen, overlay, swap
+	FRAME_SECTION_CAPTURE,          // frame capture copy
+	FRAME_SECTIONS
+} FrameSection;
+
+static const char *frameSectionNames[FRAME_SECTIONS] = { "update", "pixels", "layers", "background", "sprites", "quads", "present", "capture" };
+
+#define FRAME_TIME_STEP (1.0f/60.0f)
+#define FRAME_TIME_SEED 2021
+
+typedef struct FrameTimeConfig {
+	int frames;                     // 0 when the benchmark is off
+	int warmup;
+	const char *output;
+} FrameTimeConfig;
+
+typedef struct FrameTimer {
+	FrameTimeConfig config;
+	int frame;                      // frames run, warm up included
+	double frameStart;
+	double sectionStart;
+	int section;                    // section being timed, -1 between sections
+	double current[FRAME_SECTIONS]; // this frame, a section can be entered several times
+	float *times;                   // frames x (1 + FRAME_SECTIONS), whole frame first
+} FrameTimer;
+
+static FrameTimeConfig ParseFrameTimeArgs(int argc, char **argv) {
+	FrameTimeConfig config = { 0, 60, "frametime.json" };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--benchmark") == 0) {
+			config.frames = 1000;
+			if (i + 1 < argc && atoi(argv[i + 1]) > 0) config.frames = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--benchmark-warmup") == 0 && i + 1 < argc) {
+			config.warmup = atoi(argv[++i]);
+			if (config.warmup < 0) config.warmup = 0;
+		} else if (strcmp(argv[i], "--benchmark-out") == 0 && i + 1 < argc) {
+			config.output = argv[++i];
+		}
+	}
+	return config;
+}
+
+static FrameTimer *LoadFrameTimer(FrameTimeConfig config) {
+	FrameTimer *timer = (FrameTimer *)calloc(1, sizeof(FrameTimer));
+	timer->config = config;
+	timer->section = -1;
+	timer->times = (float *)calloc((size_t)config.frames*(1 + FRAME_SECTIONS), sizeof(float));
+	return timer;
+}
+
+static void UnloadFrameTimer(FrameTimer *timer) {
+	free(timer->times);
+	free(timer);
+}
+
+// Section being run, timer or not, for the allocation counts
+static int frameSectionCurrent = -1;
+
+// The section functions do nothing without a timer, so the frame can be marked up unconditionally
+static void BeginFrameSection(FrameTimer *timer, FrameSection section) {
+	frameSectionCurrent = section;
+	if (timer == NULL) return;
+	timer->section = section;
+	timer->sectionStart = GetTime();
+}
+
+static void EndFrameSection(FrameTimer *timer) {
+	frameSectionCurrent = -1;
+	if (timer == NULL || timer->section < 0) return;
+	timer->current[timer->section] += GetTime() - timer->sectionStart;
+	timer->section = -1;
+}
+
+// Call at the top of the frame; closes the previous frame and returns false once every frame was measured
+static bool StepFrameTimer(FrameTimer *timer) {
+	double now = GetTime();
+
+	if (timer->frame > 0) {
+		int measured = timer->frame - 1 - timer->config.warmup;
+		if (measured >= 0) {
+			float *row = timer->times + (size_t)measured*(1 + FRAME_SECTIONS);
+			row[0] = (float)(now - timer->frameStart);
+			for (int s = 0; s < FRAME_SECTIONS; s++) row[1 + s] = (float)timer->current[s];
+		}
+	}
+	memset(timer->current, 0, sizeof(timer->current));
+	timer->frameStart = now;
+
+	return timer->frame++ < timer->config.warmup + timer->config.frames;
+}
+
+static int CompareFrameTimes(const void *a, const void *b) {
+	float ta = *(const float *)a, tb = *(const float *)b;
+	return (ta > tb) - (ta < tb);
+}
+
+// Nearest rank percentiles, in milliseconds
+static void WriteFrameTimeStats(FILE *file, const char *name, float *column, int stride, int count, float *scratch, bool last) {
+	double sum = 0;
+	for (int i = 0; i < count; i++) { scratch[i] = column[(size_t)i*stride]; sum += scratch[i]; }
+	qsort(scratch, count, sizeof(float), CompareFrameTimes);
+
+	#define FRAME_PERCENTILE(p) (scratch[(count*(p) + 99)/100 > 0 ? (count*(p) + 99)/100 - 1 : 0]*1000.0)
+	fprintf(file, "    \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+		name, sum*1000.0/count, FRAME_PERCENTILE(50), FRAME_PERCENTILE(90), FRAME_PERCENTILE(99), scratch[count - 1]*1000.0, last ? "" : ",");
+	#undef FRAME_PERCENTILE
+}
+
+// Writes the JSON report; 'scale' are the stress multipliers the run used, so runs at other sizes are not compared
+static bool WriteFrameTimeReport(FrameTimer *timer, const int *scale, int scaleCount) {
+	int count = timer->frame - 1 - timer->config.warmup;
+	if (count > timer->config.frames) count = timer->config.frames;
+	if (count <= 0) return false;
+
+	FILE *file = fopen(timer->config.output, "w");
+	if (file == NULL) {
+		TraceLog(LOG_WARNING, "BENCHMARK: could not write %s", timer->config.output);
+		return false;
+	}
+
+	struct utsname host;
+	if (uname(&host) != 0) memset(&host, 0, sizeof(host));
+	const char *software = getenv("LIBGL_ALWAYS_SOFTWARE");
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"frames\": %i,\n  \"warmup\": %i,\n  \"step_ms\": %.4f,\n  \"seed\": %i,\n", count, timer->config.warmup, FRAME_TIME_STEP*1000.0, FRAME_TIME_SEED);
+	fprintf(file, "  \"scale\": [");
+	for (int i = 0; i < scaleCount; i++) fprintf(file, "%s%i", i ? ", " : "", scale[i]);
+	fprintf(file, "],\n");
+	fprintf(file, "  \"host\": { \"system\": \"%s\", \"release\": \"%s\", \"machine\": \"%s\", \"cpus\": %li, \"software_gl\": %s },\n",
+		host.sysname, host.release, host.machine, sysconf(_SC_NPROCESSORS_ONLN), (software != NULL && software[0] == '1') ? "true" : "false");
+	fprintf(file, "  \"build\": { \"compiler\": \"%s\", \"date\": \"%s\" },\n", __VERSION__, __DATE__);
+
+	float *scratch = (float *)malloc(count*sizeof(float));
+	int stride = 1 + FRAME_SECTIONS;
+	fprintf(file, "  \"frame_ms\": {\n");
+	WriteFrameTimeStats(file, "total", timer->times, stride, count, scratch, true);
+	fprintf(file, "  },\n  \"sections_ms\": {\n");
+	for (int s = 0; s < FRAME_SECTIONS; s++) {
+		WriteFrameTimeStats(file, frameSectionNames[s], timer->times + 1 + s, stride, count, scratch, s == FRAME_SECTIONS - 1);
+	}
+	fprintf(file, "  }\n}\n");
+	free(scratch);
+
+	fclose(file);
+	TraceLog(LOG_INFO, "BENCHMARK: %i frames written to %s", count, timer->config.output);
+	return true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __LAYERCACHE_H__
+#define __LAYERCACHE_H__
+
+#pragma once
+
+#include <raylib.h>
+#include "resources.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Layer cache
+// Renders content that rarely changes once into an offscreen texture, and only renders it again when the
+// key built from its inputs changes. Refresh layers before BeginTextureMode(frameBuffer): raylib cannot
+// nest texture modes, EndTextureMode always returns to the backbuffer.
+
+typedef struct LayerCache {
+	RenderTexture2D target;
+	unsigned int key;
+	bool valid;
+} LayerCache;
+
+typedef struct LayerCacheStats {
+	int hits;
+	int misses;
+} LayerCacheStats;
+
+static LayerCacheStats layerCacheStats = { 0 };
+
+// FNV-1a, good enough to notice changed inputs
+static unsigned int LayerCacheKey(unsigned int key, const void *data, int size) {
+	const unsigned char *p = (const unsigned char *)data;
+	if (key == 0) key = 2166136261u;
+	for (int i = 0; i < size; i++) {
+		key ^= p[i];
+		key *= 16777619u;
+	}
+	return key;
+}
+
+static LayerCache LoadLayerCache(int width, int height) {
+	LayerCache layer = { 0 };
+	layer.target = LoadTrackedRenderTexture(width, height, "layer cache");
+	SetTextureFilter(layer.target.texture, FILTER_POINT);
+	return layer;
+}
+
+static void UnloadLayerCache(LayerCache *layer) {
+	UnloadTrackedRenderTexture(layer->target);
+	layer->valid = false;
+}
+
+// Call once per frame with the current inputs key. Returns true when the layer has to be drawn again,
+// in which case the texture mode is already active and EndLayerCache() must follow.
+static bool BeginLayerCache(LayerCache *layer, unsigned int key) {
+	if (layer->valid && layer->key == key) {
+		layerCacheStats.hits++;
+		return false;
+	}
+
+	layerCacheStats.misses++;
+	layer->key = key;
+	layer->valid = true;
+
+	BeginTextureMode(layer->target);
+	ClearBackground(BLANK);
+	return true;
+}
+
+static void EndLayerCache(LayerCache *layer) {
+	(void)layer;
+	EndTextureMode();
+}
+
+static void InvalidateLayerCache(LayerCache *layer) {
+	layer->valid = false;
+}
+
+// Source rectangle inside the cached layer, in the layer's own top-down coordinates
+// (render textures are stored upside down)
+static Rectangle LayerCacheSource(LayerCache *layer, Rectangle rec) {
+	return (Rectangle) { rec.x, layer->target.texture.height - rec.y - rec.height, rec.width, -rec.height };
+}
+
+static void ResetLayerCacheStats(void) {
+	layerCacheStats.hits = 0;
+	layerCacheStats.misses = 0;
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef __LOD_H__
+#define __LOD_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Level of detail governor
+// Each effect has a quality knob with a few levels, level 0 being the full demo. The governor smooths the CPU
+// time of each frame and walks a priority table: over the high water mark for a few frames it takes the next
+// step down the table, under the low water mark for longer it takes the last step back. After a change it
+// waits for the average to settle, and a step up undone soon after makes the next step up wait twice as long.
+//
+//     ./demo --lod-budget 12        budget in ms, the refresh rate by default
+//     ./demo --lod-step 6           fixed step of the table, no governing
+//     ./demo --no-lod
+//
+// Runs that must be repeatable (benchmark, stress, record, replay, golden) keep the full demo.
+
+typedef enum { LOD_COPPER_COLUMNS = 0, LOD_COPPER_LAYERS, LOD_LOGO, LOD_FLAG, LOD_STARS, LOD_SCROLLER, LOD_EFFECTS } LodEffect;
+
+#define LOD_LEVELS 4
+
+static const char *lodEffectNames[LOD_EFFECTS] = { "columns", "layers", "logo strip", "flag span", "stars", "tilt" };
+
+// Knob values per level: copper columns and layers, logo texel rows per strip, flag glyphs per cell side,
+// stars per field (MAXSTARS at level 0), wave scroller glyph tilt on or off
+static const int lodValues[LOD_EFFECTS][LOD_LEVELS] = {
+	{ 160, 80, 40, 20 },
+	{ 11, 8, 5, 3 },
+	{ 1, 2, 3, 4 },
+	{ 1, 2, 4, 4 },
+	{ 8, 6, 4, 2 },
+	{ 1, 0, 0, 0 },
+};
+
+// Steps down, in order, when over budget; back up in reverse. Cheap to lose first, the flag last.
+static const LodEffect lodPriority[] = {
+	LOD_SCROLLER, LOD_STARS, LOD_COPPER_LAYERS, LOD_LOGO, LOD_STARS, LOD_COPPER_COLUMNS, LOD_COPPER_LAYERS, LOD_LOGO,
+	LOD_FLAG, LOD_STARS, LOD_COPPER_COLUMNS, LOD_COPPER_LAYERS, LOD_LOGO, LOD_COPPER_COLUMNS, LOD_FLAG,
+};
+
+#define LOD_STEPS ((int)(sizeof(lodPriority)/sizeof(lodPriority[0])))
+#define LOD_SMOOTHING 0.1f              // weight of the last frame in the average
+#define LOD_HIGH 0.9f                   // of the budget
+#define LOD_LOW 0.6f
+#define LOD_DOWN_FRAMES 6               // over the high mark in a row before a step down
+#define LOD_UP_FRAMES 90                // under the low mark in a row before a step up, at first
+#define LOD_MAX_UP_FRAMES (16*LOD_UP_FRAMES)
+#define LOD_HOLD_FRAMES 20              // after a change
+#define LOD_WARMUP_FRAMES 60            // texture uploads and caches filling
+
+typedef struct LodConfig {
+	bool enabled;
+	float budget;                   // seconds, 0 for the refresh rate
+	int step;                       // fixed step, -1 when governed
+} LodConfig;
+
+typedef struct LodGovernor {
+	LodConfig config;
+	bool governed;
+	float budget;
+	int step;                       // steps of lodPriority taken
+	int level[LOD_EFFECTS];
+	float average;                  // smoothed frame work, seconds
+	int over, under;                // frames in a row above the high mark, below the low mark
+	int hold;                       // frames before the next change
+	int upFrames;                   // under the low mark before a step up
+	int sinceUp;                    // frames since the last step up
+	int frame;
+} LodGovernor;
+
+static LodConfig ParseLodArgs(int argc, char **argv) {
+	LodConfig config = { true, 0, -1 };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--no-lod") == 0) {
+			config.enabled = false;
+		} else if (strcmp(argv[i], "--lod-budget") == 0 && i + 1 < argc) {
+			config.budget = atof(argv[++i])/1000.0f;
+			if (config.budget < 0) config.budget = 0;
+		} else if (strcmp(argv[i], "--lod-step") == 0 && i + 1 < argc) {
+			config.step = atoi(argv[++i]);
+			if (config.step < 0) config.step = 0;
+			if (config.step > LOD_STEPS) config.step = LOD_STEPS;
+		}
+	}
+	return config;
+}
+
+static void SetLodStep(LodGovernor *lod, int step) {
+	lod->step = step;
+	memset(lod->level, 0, sizeof(lod->level));
+	for (int i = 0; i < step; i++) lod->level[lodPriority[i]]++;
+}
+
+// 'repeatable' keeps the full demo for runs compared frame by frame
+static LodGovernor LoadLodGovernor(LodConfig config, int refreshRate, bool repeatable) {
+	LodGovernor lod = { config };
+	lod.budget = (config.budget > 0) ? config.budget : 1.0f/((refreshRate > 0) ? refreshRate : 60);
+	lod.governed = config.enabled && config.step < 0 && !repeatable;
+	lod.upFrames = LOD_UP_FRAMES;
+	lod.sinceUp = LOD_MAX_UP_FRAMES;
+	SetLodStep(&lod, (config.enabled && config.step >= 0 && !repeatable) ? config.step : 0);
+	return lod;
+}
+
+static int LodValue(const LodGovernor *lod, LodEffect effect) {
+	return lodValues[effect][lod->level[effect]];
+}
+
+// Feeds the CPU time of the last frame and its whole duration (a missed vsync shows there), returns true when
+// the levels changed
+static bool StepLodGovernor(LodGovernor *lod, float work, float frameTime) {
+	if (!lod->governed || lod->frame++ < LOD_WARMUP_FRAMES) return false;
+
+	float load = work;
+	if (frameTime > 1.5f*lod->budget && frameTime > load) load = frameTime;
+	lod->average += (load - lod->average)*LOD_SMOOTHING;
+	lod->sinceUp++;
+
+	lod->over = (lod->average > LOD_HIGH*lod->budget) ? lod->over + 1 : 0;
+	lod->under = (lod->average < LOD_LOW*lod->budget) ? lod->under + 1 : 0;
+	if (lod->hold > 0) { lod->hold--; return false; }
+
+	if (lod->over >= LOD_DOWN_FRAMES && lod->step < LOD_STEPS) {
+		if (lod->sinceUp < lod->upFrames) lod->upFrames = (2*lod->upFrames < LOD_MAX_UP_FRAMES) ? 2*lod->upFrames : LOD_MAX_UP_FRAMES;
+		SetLodStep(lod, lod->step + 1);
+	} else if (lod->under >= lod->upFrames && lod->step > 0) {
+		SetLodStep(lod, lod->step - 1);
+		lod->sinceUp = 0;
+	} else {
+		return false;
+	}
+	lod->over = lod->under = 0;
+	lod->hold = LOD_HOLD_FRAMES;
+	return true;
+}
+
+// One line for the overlay, the step and the knob values
+static const char *LodText(const LodGovernor *lod) {
+	static char text[256];
+	int length = snprintf(text, sizeof(text), "lod %s step %i/%i, %.1f of %.1f ms:", lod->governed ? "auto" : "fixed", lod->step, LOD_STEPS,
+		lod->average*1000.0f, lod->budget*1000.0f);
+	for (int e = 0; e < LOD_EFFECTS && length < (int)sizeof(text); e++) {
+		length += snprintf(text + length, sizeof(text) - length, " %s %i", lodEffectNames[e], LodValue(lod, (LodEffect)e));
+	}
+	return text;
+}
+
+#endif
@@ -5,6 +5,29 @@
 #include <string.h>
 #include "data.h"
 #include "rlgl.h"               // raylib OpenGL abstraction layer to OpenGL 1.1, 3.3 or ES2
+#include "resources.h"
+#include "layercache.h"
+#include "bitmapfont.h"
+#include "scroller.h"
+#include "arena.h"
+#include "sprites.h"
+#include "starfield.h"
+#include "copper.h"
+#include "pixelfx.h"
+#include "effects.h"
+#include "cloth.h"
+#include "stress.h"
+#include "lod.h"
+#include "capture.h"
+#include "renderqueue.h"
+#include "cull.h"
+#include "frametime.h"
+#include "allocs.h"
+#include "replay.h"
+#include "assetpack.h"
+#include "startup.h"
+#include "tracker.h"
+#include "pcmcache.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -12,217 +35,257 @@
 #define max(a, b) ((a) > (b) ? (a) : (b))
 #define min(a, b) ((a) < (b) ? (a) : (b))
 
-#define __STARFIELD_H__ 
-#define MAXSTARS 8
-
-typedef struct Stars {
-	float x;
-	float y;
-	float speedX;
-	float speedY;
-    float xsin;
-    float ysin;
-} Stars;
-
-typedef struct Starfield2D {
-	Texture2D sprite;
-	Vector2 position;
-	Vector2 size;
-	Stars stars[MAXSTARS];
-} Starfield2D;
-
-static int chars_x = 32;
-static int chars_y = 12;
-
-static Vector2 grid_pos[12][32];
-
-Starfield2D Init_Starfield2D(Texture2D sprite, Vector2 position, Vector2 size);
-void SetSpeed_Starfield2D(Starfield2D *starfield, Vector2 speed);
-void Draw_Starfield2D(Starfield2D *starfield, Vector2 velocity);
-
 inline static float Rand(float a) {
 	return (float)rand()/(float)(RAND_MAX/a);
 }
 
 
-// Draw a part of a texture (defined by a rectangle) with 'pro' parameters
-// NOTE: origin is relative to destination rectangle size
-void DrawTextureProSK (Texture2D texture, Rectangle source, Rectangle dest, Vector2 skew, float rotation, Color tint)
-{
-    // Check if texture is valid
-    if (texture.id > 0)
-    {
-        float width = (float)texture.width;
-        float height = (float)texture.height;
-
-        bool flipX = false;
-
-        if (source.width < 0) { flipX = true; source.width *= -1; }
-        if (source.height < 0) source.y -= source.height;
-
-        rlEnableTexture(texture.id);
-
-        rlPushMatrix();
-            rlTranslatef(dest.x, dest.y, 0.0f);
-            rlRotatef(rotation, 0.0f, 0.0f, 1.0f);
-            //rlTranslatef(-origin.x, -origin.y, 0.0f);
-
-            rlBegin(RL_QUADS);
-                rlColor4ub(tint.r, tint.g, tint.b, tint.a);
-                rlNormal3f(0.0f, 0.0f, 1.0f);                          // Normal vector pointing towards viewer
-
-                // Bottom-left corner for texture and quad
-                if (flipX) rlTexCoord2f((source.x + source.width)/width, source.y/height);
-                else rlTexCoord2f(source.x/width, source.y/height);
-                rlVertex2f(0.0f + skew.x, 0.0f);
-
-                // Bottom-right corner for texture and quad
-                if (flipX) rlTexCoord2f((source.x + source.width)/width, (source.y + source.height)/height);
-                else rlTexCoord2f(source.x/width, (source.y + source.height)/height);
-                rlVertex2f(0.0f, dest.height);
-
-                // Top-right corner for texture and quad
-                if (flipX) rlTexCoord2f(source.x/width, (source.y + source.height)/height);
-                else rlTexCoord2f((source.x + source.width)/width, (source.y + source.height)/height);
-                rlVertex2f(dest.width, dest.height + skew.y);
-
-                // Top-left corner for texture and quad
-                if (flipX) rlTexCoord2f(source.x/width, source.y/height);
-                else rlTexCoord2f((source.x + source.width)/width, (source.y)/height);
-                rlVertex2f(dest.width + skew.x, 0.0f + skew.y);
-            rlEnd();
-        rlPopMatrix();
-
-        rlDisableTexture();
-    }
-}
+Vector2 VirtualScreen = (Vector2) { 1280, 720};
 
+void DrawQuadSprite ( Texture2D sprite , Vector2 position, float scaleX, float scaleY, Color color);
+void DrawFrameBuffer(RenderTexture2D renderer);
+void DrawTextImage(Texture2D texture, char * txt, float x, float y );
 
 // -------------------------------------------------------------------------------------------------------------
-Starfield2D Init_Starfield2D(Texture2D sprite, Vector2 position, Vector2 size) {
-	Starfield2D p;
-	p.sprite = sprite;
-	p.position = position;
-	p.size = size;
-	
-	for(int i = 0; i < MAXSTARS; i++) {
-		p.stars[i].x = GetRandomValue(p.position.x , p.position.x + p.size.x);
-		p.stars[i].y = GetRandomValue(p.position.y , p.position.y + p.size.y);
-	}
+// Startup tasks run on worker threads while the main thread creates the window and uploads textures
 
-	return p;
+static void StartAudioDevice(StartupGraph *graph, void *context) {
+	InitAudioDevice();
 }
 
-void SetSpeed_Starfield2D(Starfield2D *starfield, Vector2 speed) {
-	for(int i = 0; i < MAXSTARS; i++) {
-		starfield->stars[i].speedX = speed.x;
-		starfield->stars[i].speedY = speed.y;
-		starfield->stars[i].xsin = GetRandomValue(0,360);
-		starfield->stars[i].ysin = GetRandomValue(0,360);
+typedef struct PackStartup { const char *path; AssetPack *pack; } PackStartup;
+typedef struct MusicStartup { MusicCacheConfig config; TrackerConfig tracker; const PackStartup *pack; MusicTrack *track; } MusicStartup;
+
+// Starts the music and keeps its stream fed until the main loop takes over. A module given with --module comes
+// first, then one in the asset pack, then NTMMEG.ogg.
+static void StartMusic(StartupGraph *graph, void *context) {
+	MusicStartup *startup = (MusicStartup *)context;
+	MusicTrack *music = startup->track;
+	size_t size = 0;
+	const unsigned char *packed;
+	if (startup->tracker.module != NULL) {
+		unsigned char *data = ReadTrackerFile(startup->tracker.module, &size);
+		if (data != NULL) *music = LoadModuleTrack(data, size, startup->tracker.module);
+		else TraceLog(LOG_WARNING, "MUSIC: could not read %s", startup->tracker.module);
+		free(data);
+	} else if ((packed = LoadAssetData(startup->pack->pack, "music", &size)) != NULL) {
+		*music = LoadModuleTrack(packed, size, "music");
+	}
+	if (!MusicTrackReady(music)) *music = LoadMusicTrack("NTMMEG.ogg", startup->config);
+	if (!MusicTrackReady(music)) return;
+	PlayMusicTrack(music);
+	UpdateMusicTrack(music);
+	MarkStartupAudio(graph);
+	while (!StartupFinishing(graph)) {
+		usleep(5000);
+		UpdateMusicTrack(music);
 	}
 }
 
-void Draw_Starfield2D(Starfield2D *starfield, Vector2 velocity) {
-	for(int i = 0; i < MAXSTARS; i++) {
-		starfield->stars[i].x += starfield->stars[i].speedX * velocity.x;
-		starfield->stars[i].y += starfield->stars[i].speedY * velocity.y;
-
-		if( starfield->stars[i].x > ( starfield->position.x + starfield->size.x ) ) {
-			starfield->stars[i].x = starfield->position.x;
-			starfield->stars[i].y = GetRandomValue(starfield->position.y , starfield->position.y + starfield->size.y);
-		}
-
-		if( starfield->stars[i].y > ( starfield->position.y + starfield->size.y ) ) {
-			starfield->stars[i].y = starfield->position.y;
-			starfield->stars[i].x = GetRandomValue(starfield->position.x , starfield->position.x + starfield->size.x);
-		}
+static void OpenAssets(StartupGraph *graph, void *context) {
+	PackStartup *startup = (PackStartup *)context;
+	startup->pack = OpenAssetPack(startup->path);
+	if (startup->pack != NULL) PrefetchAssetPack(startup->pack);
+}
 
-		if( starfield->stars[i].x < starfield->position.x ) starfield->stars[i].x = starfield->position.x + starfield->size.x;
-		if( starfield->stars[i].y > ( starfield->position.y + starfield->size.y ) ) starfield->stars[i].y = starfield->position.y;
-		if( starfield->stars[i].y < starfield->position.y ) starfield->stars[i].y = starfield->position.y + starfield->size.y;
+typedef struct StarfieldStartup { Starfield2D **fields; const Texture2D *sprites[8]; } StarfieldStartup;
 
-		DrawTexture(starfield->sprite, starfield->stars[i].x + sin(starfield->stars[i].xsin)* velocity.y *8, starfield->stars[i].y + sin(starfield->stars[i].ysin)* velocity.y , WHITE);
-        starfield->stars[i].xsin += .1 ;
-        starfield->stars[i].ysin += .1 ;
-	}
+// Draws from rand(), so it runs after the window task seeded it and nothing else draws meanwhile
+static void SetupStarfields(StartupGraph *graph, void *context) {
+	StarfieldStartup *startup = (StarfieldStartup *)context;
+	for (int i = 0; i < 8; i++) *startup->fields[i] = Init_Starfield2D(*startup->sprites[i], (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
+	for (int i = 0; i < 8; i++) SetSpeed_Starfield2D(startup->fields[i], (Vector2) {4.0f - 0.5f*i, 4.0f - 0.5f*i});
 }
 
-Vector2 VirtualScreen = (Vector2) { 1280, 720};
-
-void DrawQuadSprite ( Texture2D sprite , Vector2 position, float scaleX, float scaleY, Color color);
-void DrawFrameBuffer(RenderTexture2D renderer);
-void DrawTextImage(Texture2D texture, char * txt, float x, float y );
+static void StartPixelPool(StartupGraph *graph, void *context) {
+	*(PixelPool **)context = LoadPixelPool(0);
+	InitPlasma();
+}
 
-int main() {
+int main(int argc, char **argv) {
+
+	StressConfig stress = ParseStressArgs(argc, argv);
+	LodConfig lodConfig = ParseLodArgs(argc, argv);
+	AllocConfig allocConfig = ParseAllocArgs(argc, argv);
+	QuadBatchConfig quadBatchConfig = ParseQuadBatchArgs(argc, argv);
+	CaptureConfig captureConfig = ParseCaptureArgs(argc, argv);
+	FrameTimeConfig frameTimeConfig = ParseFrameTimeArgs(argc, argv);
+	ReplayConfig replayConfig = ParseReplayArgs(argc, argv);
+	AssetPackConfig packConfig = ParseAssetPackArgs(argc, argv);
+	MusicCacheConfig musicCacheConfig = ParseMusicCacheArgs(argc, argv);
+	TrackerConfig trackerConfig = ParseTrackerArgs(argc, argv);
+
+	// Compiled in images, written to an asset pack with --write-pack, used when there is no pack
+	static const char *copperNames[11] = { "copper0", "copper1", "copper2", "copper3", "copper4", "copper5", "copper6", "copper7", "copper8", "copper9", "copper10" };
+	if (packConfig.write != NULL) {
+		AssetSource sources[21] = {
+			{ "icon", icon_data, 32, 32, UNCOMPRESSED_R8G8B8A8 },
+			{ "bars", bars_data, 4, 480, UNCOMPRESSED_R8G8B8A8 },
+			{ "copper_bar", copper_bar_data, 8, 34, UNCOMPRESSED_R8G8B8A8 },
+			{ "logo", logo_data, 636, 108, UNCOMPRESSED_R8G8B8A8 },
+			{ "characters", font_data, 2048, 32, UNCOMPRESSED_R8G8B8A8 },
+			{ "font2_data", font2_data, 16, 946, UNCOMPRESSED_R8G8B8A8 },
+			{ "balle1", ball1_data, 30, 30, UNCOMPRESSED_R8G8B8A8 },
+			{ "balle2", ball2_data, 22, 22, UNCOMPRESSED_R8G8B8A8 },
+			{ "balle3", ball3_data, 18, 18, UNCOMPRESSED_R8G8B8A8 },
+		};
+		for (int i = 0; i < 11; i++) sources[9 + i] = (AssetSource) { copperNames[i], copper_data[i], 4, 56, UNCOMPRESSED_R8G8B8A8 };
+		// The module given with --module goes in as raw data
+		size_t moduleSize = 0;
+		unsigned char *module = trackerConfig.module != NULL ? ReadTrackerFile(trackerConfig.module, &moduleSize) : NULL;
+		if (trackerConfig.module != NULL && module == NULL) TraceLog(LOG_WARNING, "ASSETS: could not read %s", trackerConfig.module);
+		if (module != NULL) sources[20] = (AssetSource) { "music", module, 0, 0, 0, moduleSize };
+		bool written = WriteAssetPack(packConfig.write, sources, module != NULL ? 21 : 20);
+		free(module);
+		return written ? 0 : 1;
+	}
+	bool benchmark = frameTimeConfig.frames > 0;
+	bool fixedStep = benchmark || captureConfig.golden != NULL;     // golden runs must render the same frames every time
 
+	// -------------------------------------------------------------------------------------------------------------
+	// Startup graph: audio, music, asset pack, starfields and the pixel pool run on worker threads meanwhile
+	StartupGraph *startup = CreateStartupGraph();
+	MusicTrack music = { MUSIC_CACHE_OFF };
+	PackStartup packStartup = { packConfig.path != NULL ? packConfig.path : "assets.pak", NULL };
+	MusicStartup musicStartup = { musicCacheConfig, trackerConfig, &packStartup, &music };
+	PixelPool *pixelPool = NULL;
+	Texture2D balle1, balle2, balle3;
+	Starfield2D starfield0, starfield1, starfield2, starfield3, starfield4, starfield5, starfield6, starfield7;
+	Starfield2D *starfields[8] = { &starfield0, &starfield1, &starfield2, &starfield3, &starfield4, &starfield5, &starfield6, &starfield7 };
+	StarfieldStartup starfieldStartup = { starfields, { &balle1, &balle1, &balle1, &balle2, &balle2, &balle3, &balle3, &balle3 } };
+
+	int taskWindow = AddStartupTask(startup, "window", NULL, NULL);
+	int taskAudio = AddStartupTask(startup, "audio device", StartAudioDevice, NULL);
+	int taskMusic = AddStartupTask(startup, "music", StartMusic, &musicStartup);
+	int taskPack = AddStartupTask(startup, "asset pack", OpenAssets, &packStartup);
+	int taskTextures = AddStartupTask(startup, "textures", NULL, NULL);
+	int taskStars = AddStartupTask(startup, "starfields", SetupStarfields, &starfieldStartup);
+	AddStartupTask(startup, "pixel pool", StartPixelPool, &pixelPool);        // no dependencies, FinishStartupGraph() waits for it
+	int taskTargets = AddStartupTask(startup, "render targets", NULL, NULL);
+	StartupDepends(startup, taskMusic, taskAudio);
+	StartupDepends(startup, taskMusic, taskPack);          // the module may be in the pack, mapping it is quick
+	StartupDepends(startup, taskTextures, taskWindow);
+	StartupDepends(startup, taskTextures, taskPack);
+	StartupDepends(startup, taskStars, taskTextures);
+	StartupDepends(startup, taskTargets, taskTextures);
+	RunStartupGraph(startup);
+
+	BeginStartupTask(startup, taskWindow);
+    if (benchmark) SetConfigFlags(FLAG_WINDOW_HIDDEN);
     InitWindow(VirtualScreen.x, VirtualScreen.y, "wow that is fun !");
+    if (!IsWindowReady()) {
+        TraceLog(LOG_ERROR, "DEMO: no window, without a display run under xvfb-run");
+        FinishStartupGraph(startup);
+        return 1;
+    }
     SetExitKey(NULL);
 
     int current_monitor = GetCurrentMonitor();
     int screenWidth = GetMonitorWidth(current_monitor);
     int screenHeight = GetMonitorHeight(current_monitor);
-    SetWindowState(FLAG_FULLSCREEN_MODE);
-    SetWindowSize(screenWidth,screenHeight);
+    if (!benchmark) {
+        SetWindowState(FLAG_FULLSCREEN_MODE);
+        SetWindowSize(screenWidth,screenHeight);
+    }
     SetTargetFPS(GetMonitorRefreshRate(current_monitor));
+    if (StressActive(&stress)) SetTargetFPS(0);      // measure the real frame time, not the frame limiter
+    if (benchmark) {
+        SetTargetFPS(0);
+        ClearWindowState(FLAG_VSYNC_HINT);
+    }
+    if (fixedStep) srand(FRAME_TIME_SEED);          // InitWindow seeds from the clock, the stars need the same start
+
+    // Recorded frame times, seeds and keys (--record file, --replay file), seeded before the stars are placed
+    Replay *replay = OpenReplay(replayConfig, fixedStep ? FRAME_TIME_SEED : (unsigned int)rand());
+    if (replayConfig.replay != NULL && replay == NULL) {
+        FinishStartupGraph(startup);
+        CloseWindow();
+        return 1;
+    }
 	
     int framecount = 0;
 
 	HideCursor();
 
     enum { STATE_WAITING, STATE_LOADING, STATE_FINISHED } state = STATE_WAITING;
+	EndStartupTask(startup, taskWindow);
+
+	// -------------------------------------------------------------------------------------------------------------
+	// Asset pack, mapped; images it has are uploaded from the mapping and their pages released right after
+	WaitStartupTask(startup, taskPack);
+	AssetPack *assets = packStartup.pack;
+	if (packConfig.path != NULL && assets == NULL) {
+		TraceLog(LOG_ERROR, "ASSETS: could not open %s", packConfig.path);
+		FinishStartupGraph(startup);
+		CloseWindow();
+		return 1;
+	}
+	BeginStartupTask(startup, taskTextures);
 
 	// -------------------------------------------------------------------------------------------------------------
 	// Icone window
-	Image icon = {&icon_data, 32, 32, 1, UNCOMPRESSED_R8G8B8A8};
+	Image icon = LoadAssetImage(assets, "icon", (Image) {&icon_data, 32, 32, 1, UNCOMPRESSED_R8G8B8A8});
 	SetWindowIcon(icon);
+	ReleaseAsset(assets, "icon");
 
 	// -------------------------------------------------------------------------------------------------------------
 	// Copper
 	Texture2D copper[11];
+	Image copperImages[11];
 	for(int i = 0; i < 11; i++) {
-        Image _copper = {&copper_data[i], 4, 56, 1, UNCOMPRESSED_R8G8B8A8};
-		copper[i] = LoadTextureFromImage(_copper);
+        copperImages[i] = LoadAssetImage(assets, copperNames[i], (Image) {&copper_data[i], 4, 56, 1, UNCOMPRESSED_R8G8B8A8});
+		copper[i] = LoadTrackedTexture(copperImages[i], "copper");
 	}
 
+	// Copper list: one color per scanline (F2 switches from the copper columns)
+	CopperList *copperList = LoadCopperList(VirtualScreen.y);
+	CopperGradient copperGradients[11];
+	for(int i = 0; i < 11; i++) copperGradients[i] = CopperGradientFromImage(copperImages[i].data, copperImages[i].width, 0, copperImages[i].height);
+	for(int i = 0; i < 11; i++) ReleaseAsset(assets, copperNames[i]);     // the copper list pages them back in when F2 is on
+	Image bars = LoadAssetImage(assets, "bars", (Image) {&bars_data, 4, 480, 1, UNCOMPRESSED_R8G8B8A8});
+	CopperGradient barsGradient = CopperGradientFromImage(bars.data, bars.width, 46, 6);   // 4x480, red rule
+	bool copperMode = false;
+
 	// -------------------------------------------------------------------------------------------------------------
 	// Copper Bar
-	Image cop1 = {&copper_bar_data, 8, 34, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D copper_bar = LoadTextureFromImage(cop1);
+	Image cop1 = LoadAssetImage(assets, "copper_bar", (Image) {&copper_bar_data, 8, 34, 1, UNCOMPRESSED_R8G8B8A8});
+	Texture2D copper_bar = LoadTrackedTexture(cop1, "copper_bar");
+	ReleaseAsset(assets, "copper_bar");
 
 	// -------------------------------------------------------------------------------------------------------------
 	// Logo
-	Image _logo = {&logo_data, 636, 108, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D logo = LoadTextureFromImage(_logo);
+	Image _logo = LoadAssetImage(assets, "logo", (Image) {&logo_data, 636, 108, 1, UNCOMPRESSED_R8G8B8A8});
+	Texture2D logo = LoadTrackedTexture(_logo, "logo");
+	ReleaseAsset(assets, "logo");
 
 	// -------------------------------------------------------------------------------------------------------------
 	// Fonte
-	Image fontData = {&font_data, 2048, 32, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D characters = LoadTextureFromImage(fontData);
+	Image fontData = LoadAssetImage(assets, "characters", (Image) {&font_data, 2048, 32, 1, UNCOMPRESSED_R8G8B8A8});
+	Texture2D characters = LoadTrackedTexture(fontData, "characters");
+	ReleaseAsset(assets, "characters");
 
-	Image _font2_data = {&font2_data, 16, 946, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D font2_data = LoadTextureFromImage(_font2_data);
+	Image _font2_data = LoadAssetImage(assets, "font2_data", (Image) {&font2_data, 16, 946, 1, UNCOMPRESSED_R8G8B8A8});
+	Texture2D font2_data = LoadTrackedTexture(_font2_data, "font2_data");
+	ReleaseAsset(assets, "font2_data");
 
 	// -------------------------------------------------------------------------------------------------------------
 	// Balles
-	Image _balle1_data = {&ball1_data, 30, 30, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D balle1 = LoadTextureFromImage(_balle1_data);
-	Image _balle2_data = {&ball2_data, 22, 22, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D balle2 = LoadTextureFromImage(_balle2_data);
-	Image _balle3_data = {&ball3_data, 18, 18, 1, UNCOMPRESSED_R8G8B8A8};
-	Texture2D balle3 = LoadTextureFromImage(_balle3_data);
-
-	// -------------------------------------------------------------------------------------------------------------
-	// Music
-    
-	InitAudioDevice();
-
-	Music music = LoadMusicStream("NTMMEG.ogg");
-	PlayMusicStream(music);
-//	SetMusicVolume(music, 1.0f);
+	Image _balle1_data = LoadAssetImage(assets, "balle1", (Image) {&ball1_data, 30, 30, 1, UNCOMPRESSED_R8G8B8A8});
+	balle1 = LoadTrackedTexture(_balle1_data, "balle1");
+	Image _balle2_data = LoadAssetImage(assets, "balle2", (Image) {&ball2_data, 22, 22, 1, UNCOMPRESSED_R8G8B8A8});
+	balle2 = LoadTrackedTexture(_balle2_data, "balle2");
+	Image _balle3_data = LoadAssetImage(assets, "balle3", (Image) {&ball3_data, 18, 18, 1, UNCOMPRESSED_R8G8B8A8});
+	balle3 = LoadTrackedTexture(_balle3_data, "balle3");
+	ReleaseAsset(assets, "balle1");
+	ReleaseAsset(assets, "balle2");
+	ReleaseAsset(assets, "balle3");
+	if (assets != NULL) TraceLog(LOG_INFO, "ASSETS: %i KB of %i KB released after upload", (int)(assets->released/1024), (int)(assets->size/1024));
+	EndStartupTask(startup, taskTextures);
 
 	// -------------------------------------------------------------------------------------------------------------
 	// Framebuffer
-	RenderTexture2D frameBuffer = LoadRenderTexture( VirtualScreen.x, VirtualScreen.y );
+	BeginStartupTask(startup, taskTargets);
+	RenderTexture2D frameBuffer = LoadTrackedRenderTexture( VirtualScreen.x, VirtualScreen.y, "frameBuffer" );
 	SetTextureFilter(frameBuffer.texture, FILTER_POINT);
 
 	// -------------------------------------------------------------------------------------------------------------
@@ -246,46 +309,140 @@ int main() {
 	float scrollTextX = VirtualScreen.x;
 	int textLen = strlen(scrollText);
 	int textLen2 = strlen(scrollText2);
-    int x_offset, y_offset;
 
 	float rastsin=0;
 	float rastoffset=0.07;
 	float amp=300;
 
-	Starfield2D starfield0 = Init_Starfield2D(balle1, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield1 = Init_Starfield2D(balle1, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield2 = Init_Starfield2D(balle1, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield3 = Init_Starfield2D(balle2, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield4 = Init_Starfield2D(balle2, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield5 = Init_Starfield2D(balle3, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield6 = Init_Starfield2D(balle3, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-	Starfield2D starfield7 = Init_Starfield2D(balle3, (Vector2) {-32,-32}, (Vector2) {VirtualScreen.x+32,VirtualScreen.y+32});
-
-	SetSpeed_Starfield2D(&starfield0, (Vector2){4.0,4.0});
-	SetSpeed_Starfield2D(&starfield1, (Vector2){3.5,3.5});
-	SetSpeed_Starfield2D(&starfield2, (Vector2){3.0,3.0});
-	SetSpeed_Starfield2D(&starfield3, (Vector2){2.5,2.5});
-	SetSpeed_Starfield2D(&starfield4, (Vector2){2.0,2.0});
-	SetSpeed_Starfield2D(&starfield5, (Vector2){1.5,1.5});
-	SetSpeed_Starfield2D(&starfield6, (Vector2){1.0,1.0});
-	SetSpeed_Starfield2D(&starfield7, (Vector2){0.5,0.5});
-
-	float sinx = 0;
-	float siny = 0;
-	float oldsinx = 0;
-	float oldsiny = 0;
+	// Starfields are set up by their startup task, from the ball textures
+	// One instance batch per ball texture, each drawn with one call per layer group
+	InitSpriteRenderer();
+	SpriteBatch balls1 = LoadSpriteBatch(balle1, 3*MAXSTARS);
+	SpriteBatch balls2 = LoadSpriteBatch(balle2, 2*MAXSTARS);
+	SpriteBatch balls3 = LoadSpriteBatch(balle3, 3*MAXSTARS);
+
+	// The render queue's own vertex batch, sized from the quads each frame draws
+	QuadBatch quadBatch = LoadQuadBatch(quadBatchConfig);
+
     float sinparam = 0;
 
-	float ySin[strlen(scrollText2)];
+	// Sine flag, 32x12 cells of 32px showing 16px glyphs
+	SineFlag flag = { 32, 12, 32, 16, 1, 0, 0 };
+
+	// The same cells as a cloth on the pixel pool (F6 switches)
+	ClothFlag cloth = LoadClothFlag(flag.columns, flag.rows, flag.cellSize, VirtualScreen.x);
+	bool clothMode = false;
+	double clothMs = 0;
+
+	// -------------------------------------------------------------------------------------------------------------
+	// Cached layers (flag glyphs, copper bar strip)
+	LayerCache flagLayer = LoadLayerCache(flag.columns*16, flag.rows*16);
+	LayerCache copperBarLayer = LoadLayerCache(VirtualScreen.x, 68);
+
+	// -------------------------------------------------------------------------------------------------------------
+	// Glyph tables and texts as glyph indices
+	BitmapFont bigFont = LoadBitmapFont(characters, 32, 32, 32);
+	BitmapFont smallFont = LoadBitmapFont(font2_data, 16, 16, 32);
+	BitmapText flagGlyphs = LoadBitmapText(&smallFont, text1);
+	BitmapText scrollGlyphs = LoadBitmapText(&bigFont, scrollText);
+	BitmapText scrollGlyphs2 = LoadBitmapText(&smallFont, scrollText2);
+
+	// Big scroller pre-rendered into strip pages (F1 toggles back to one quad per glyph)
+	StripScroller bigScroller = LoadStripScroller(&bigFont, &scrollGlyphs);
+	bool stripScroller = true;
+
+	// -------------------------------------------------------------------------------------------------------------
+	// CPU pixel effects (F3 shows the plasma behind everything)
+	PixelBuffer plasma = LoadPixelBuffer(VirtualScreen.x, VirtualScreen.y);
+	Image _plasma = {plasma.pixels, plasma.width, plasma.height, 1, UNCOMPRESSED_R8G8B8A8};
+	Texture2D plasmaTexture = LoadTrackedTexture(_plasma, "plasma");
+	bool plasmaMode = false;
+	EndStartupTask(startup, taskTargets);
+
+	// -------------------------------------------------------------------------------------------------------------
+	// Per-frame scratch memory, reset at the start of each frame
+	FrameArena frameArena = InitFrameArena(64*1024);
+
+	float *ySin;
 	float textX = VirtualScreen.x;
     float curve;
 
+	// -------------------------------------------------------------------------------------------------------------
+	// Stress mode: effect sizes are scaled by the multipliers, the sweep changes them as it goes
+	StressSweep *stressSweep = stress.sweep ? StartStressSweep(stress) : NULL;
+	int stressScale[STRESS_EFFECTS] = { 1, 1, 1, 1 };
+	int copperColumns = 160;
+	int copperLayers = 11;
+	int logoRows = logo.height;
+	int starCount = 0;              // per starfield, set on the first frame
+
+	// Level of detail, stepped down when frames run over the budget (the full demo for repeatable runs)
+	bool repeatable = benchmark || StressActive(&stress) || replayConfig.record != NULL || replayConfig.replay != NULL || captureConfig.golden != NULL;
+	LodGovernor lod = LoadLodGovernor(lodConfig, GetMonitorRefreshRate(current_monitor), repeatable);
+	float lodWork = 0;
+
+	// -------------------------------------------------------------------------------------------------------------
+	// Frame capture to PNG on worker threads (F4 toggles it)
+	FrameCapture *capture = NULL;
+	if (captureConfig.every > 0) capture = LoadFrameCapture(VirtualScreen.x, VirtualScreen.y, captureConfig);
+	int exitCode = (captureConfig.golden != NULL && capture == NULL) ? 1 : 0;     // a golden run that cannot compare fails
+
+	// Headless frame time benchmark (--benchmark N), fixed time step
+	FrameTimer *frameTimer = benchmark ? LoadFrameTimer(frameTimeConfig) : NULL;
+
+	// Quads go through a render queue, sorted to merge texture switches (F5 submits them unsorted to compare)
+	bool sortedQueue = true;
+
     bool stay_in_loop = true;
 
+	// Joins the startup threads, the main loop feeds the music from here on
+	FinishStartupGraph(startup);
+	StartAllocTracking(allocConfig);
+
 	// -------------------------------------------------------------------------------------------------------------
 	// Game Loop
 	while(!WindowShouldClose() & stay_in_loop) {
-		UpdateMusicStream(music);
+		double frameStart = GetTime();
+		StepAllocFrame();
+		if (frameTimer != NULL && !StepFrameTimer(frameTimer)) break;
+		BeginFrameSection(frameTimer, FRAME_SECTION_UPDATE);
+		FrameInput input;
+		if (!NextFrameInput(replay, fixedStep ? FRAME_TIME_STEP : GetFrameTime(), &input)) break;
+		float dt = input.dt;
+		ResetFrameArena(&frameArena);
+
+		int scale[STRESS_EFFECTS];
+		memcpy(scale, stress.scale, sizeof(scale));
+		if (stressSweep != NULL) {
+			if (!StepStressSweep(stressSweep, GetFrameTime())) stay_in_loop = false;
+			StressSweepScale(stressSweep, scale);
+		}
+		bool lodChanged = StepLodGovernor(&lod, lodWork, GetFrameTime()) || framecount == 0;
+		if (memcmp(scale, stressScale, sizeof(scale)) != 0 || lodChanged) {
+			int stars = LodValue(&lod, LOD_STARS)*scale[STRESS_STARS];
+			if (stars != starCount) {
+				for (int i = 0; i < 8; i++) Resize_Starfield2D(starfields[i], stars);
+				starCount = stars;
+			}
+			copperColumns = LodValue(&lod, LOD_COPPER_COLUMNS);
+			copperLayers = LodValue(&lod, LOD_COPPER_LAYERS)*scale[STRESS_COPPER];
+			SineFlag grid = flag;
+			flag.span = LodValue(&lod, LOD_FLAG);
+			flag.columns = 32*scale[STRESS_FLAG]/flag.span;
+			flag.rows = 12*scale[STRESS_FLAG]/flag.span;
+			flag.cellSize = max(32/scale[STRESS_FLAG], 1)*flag.span;
+			logoRows = logo.height*scale[STRESS_LOGO]/LodValue(&lod, LOD_LOGO);
+			// The cloth restarts from rest, only when its grid changes
+			if (flag.columns != grid.columns || flag.rows != grid.rows || flag.cellSize != grid.cellSize || cloth.x == NULL) {
+				UnloadClothFlag(&cloth);
+				cloth = LoadClothFlag(flag.columns, flag.rows, flag.cellSize, VirtualScreen.x);
+				if (cloth.x == NULL) clothMode = false;
+			}
+			memcpy(stressScale, scale, sizeof(scale));
+		}
+		ySin = FRAME_ALLOC(&frameArena, float, textLen2);
+
+		UpdateMusicTrack(&music);
 
 		sinparam += 0.1;
 		float x = sinparam;
@@ -296,129 +453,225 @@ int main() {
 
 		// -------------------------------------------------------------------------------------------------------------
 		// Scroll Text
-		scrollTextX -= GetFrameTime() * 500;
+		scrollTextX -= dt * 500;
 		if(scrollTextX < -textLen*32+32 ) scrollTextX = VirtualScreen.x+32;
 
-		rastsin += GetFrameTime();
+		rastsin += dt;
+
+		if (input.keys & INPUT_F1) stripScroller = !stripScroller;
+		if ((input.keys & INPUT_F2) && copperList != NULL) copperMode = !copperMode;
+		if ((input.keys & INPUT_F3) && plasma.pixels != NULL && pixelPool != NULL) plasmaMode = !plasmaMode;
+		if (input.keys & INPUT_F5) sortedQueue = !sortedQueue;
+		if ((input.keys & INPUT_F6) && cloth.x != NULL && pixelPool != NULL) clothMode = !clothMode;
+		if (input.keys & INPUT_F4) {
+			if (capture != NULL) { UnloadFrameCapture(capture); capture = NULL; }
+			else capture = LoadFrameCapture(VirtualScreen.x, VirtualScreen.y, captureConfig);
+		}
+
+		EndFrameSection(frameTimer);
+		BeginFrameSection(frameTimer, FRAME_SECTION_PIXELS);
+		if (plasmaMode) {
+			PlasmaParams plasmaParams = PreparePlasma(plasma.width, plasma.height, rastsin,
+				FRAME_ALLOC(&frameArena, unsigned char, plasma.width),
+				FRAME_ALLOC(&frameArena, unsigned char, plasma.width + plasma.height),
+				FRAME_ALLOC(&frameArena, unsigned char, plasma.height));
+			plasmaParams.alpha = 96;
+			RunPixelKernel(pixelPool, &plasma, PlasmaKernel, &plasmaParams);
+			UpdateTexture(plasmaTexture, plasma.pixels);
+		}
+		if (clothMode) {
+			double clothStart = GetTime();
+			StepClothFlag(&cloth, pixelPool, dt);
+			clothMs = (GetTime() - clothStart)*1000.0;
+		}
+		EndFrameSection(frameTimer);
+		BeginFrameSection(frameTimer, FRAME_SECTION_UPDATE);
+		if (stripScroller) UpdateStripScroller(&bigScroller, scrollTextX, VirtualScreen.x);
+
+		// -------------------------------------------------------------------------------------------------------------
+		// Move the stars, grouped by the layer they are drawn in
+		ResetSpriteStats();
+		ResetCullStats();
+		Rectangle view = (Rectangle) {0, 0, VirtualScreen.x, VirtualScreen.y};
+		ClearSpriteBatch(&balls1);
+		ClearSpriteBatch(&balls2);
+		ClearSpriteBatch(&balls3);
+
+		SpriteRange backStars = BeginSpriteRange(&balls3);
+		Update_Starfield2D(&starfield7, (Vector2){0,-1}, &balls3);
+		EndSpriteRange(&backStars);
+		CullSpriteRange(&backStars, view, CULL_STARS, &frameArena);
+
+		SpriteRange midStars3 = BeginSpriteRange(&balls3);
+		Update_Starfield2D(&starfield6, (Vector2){0,-1}, &balls3);
+		Update_Starfield2D(&starfield5, (Vector2){0,-1}, &balls3);
+		EndSpriteRange(&midStars3);
+		CullSpriteRange(&midStars3, view, CULL_STARS, &frameArena);
+		SpriteRange midStars2 = BeginSpriteRange(&balls2);
+		Update_Starfield2D(&starfield4, (Vector2){0,-1}, &balls2);
+		Update_Starfield2D(&starfield3, (Vector2){0,-1}, &balls2);
+		EndSpriteRange(&midStars2);
+		CullSpriteRange(&midStars2, view, CULL_STARS, &frameArena);
+		SpriteRange midStars1 = BeginSpriteRange(&balls1);
+		Update_Starfield2D(&starfield2, (Vector2){0,-1}, &balls1);
+		Update_Starfield2D(&starfield1, (Vector2){0,-1}, &balls1);
+		EndSpriteRange(&midStars1);
+		CullSpriteRange(&midStars1, view, CULL_STARS, &frameArena);
+
+		SpriteRange frontStars = BeginSpriteRange(&balls1);
+		Update_Starfield2D(&starfield0, (Vector2){0,-1}, &balls1);
+		EndSpriteRange(&frontStars);
+		CullSpriteRange(&frontStars, view, CULL_STARS, &frameArena);
+
+		UploadSpriteBatch(&balls1);
+		UploadSpriteBatch(&balls2);
+		UploadSpriteBatch(&balls3);
+		EndFrameSection(frameTimer);
+
+		// -------------------------------------------------------------------------------------------------------------
+		// Refresh cached layers, only when their inputs changed
+		BeginFrameSection(frameTimer, FRAME_SECTION_LAYERS);
+		ResetLayerCacheStats();
+
+		unsigned int flagKey = LayerCacheKey(0, flagGlyphs.glyphs, flagGlyphs.length);
+		flagKey = LayerCacheKey(flagKey, &font2_data.id, sizeof(font2_data.id));
+		if (BeginLayerCache(&flagLayer, flagKey)) {
+			// The layer keeps the 32x12 glyphs whatever the grid size, larger grids repeat it
+			int layerColumns = flagLayer.target.texture.width/flag.glyphSize, layerRows = flagLayer.target.texture.height/flag.glyphSize;
+			GlyphQuad *glyphQuads = FRAME_ALLOC(&frameArena, GlyphQuad, layerColumns);
+			for(int y = 0; y < layerRows; y++) {
+				int quadCount = LayoutBitmapText(&smallFont, &flagGlyphs, y*layerColumns, layerColumns, (Vector2) {0, y*16}, (Vector2) {1,1}, -1, flagLayer.target.texture.width, glyphQuads);
+				DrawGlyphQuads(&smallFont, glyphQuads, quadCount, WHITE);
+			}
+			EndLayerCache(&flagLayer);
+		}
+
+		unsigned int copperBarKey = LayerCacheKey(0, &copper_bar.id, sizeof(copper_bar.id));
+		copperBarKey = LayerCacheKey(copperBarKey, &VirtualScreen, sizeof(VirtualScreen));
+		if (BeginLayerCache(&copperBarLayer, copperBarKey)) {
+			DrawTextureQuad(copper_bar, (Vector2){80,1}, (Vector2){0},(Rectangle){0,0,VirtualScreen.x,68},WHITE);
+			EndLayerCache(&copperBarLayer);
+		}
 
 		// -------------------------------------------------------------------------------------------------------------
 		// Framebuffer
+		EndFrameSection(frameTimer);
+		BeginFrameSection(frameTimer, FRAME_SECTION_BACKGROUND);
+		ResetRenderQueueStats();
+		RenderQueue queue = BeginRenderQueue(&frameArena, 2 + copperColumns*copperLayers + logoRows + 2*flag.columns*flag.rows + STRIP_PAGES + VirtualScreen.x/32 + 4 + textLen2, sortedQueue, &quadBatch);
+
 		BeginTextureMode(frameBuffer);
 		{
 			ClearBackground(BLACK);
 
-			Draw_Starfield2D(&starfield7, (Vector2){0,-1});
+			if (plasmaMode) {
+				QuadList plasmaQuad = AllocQuadList(&frameArena, 1);
+				PushTextureQuad(&plasmaQuad, plasmaTexture, (Rectangle) {0, 0, plasma.width, plasma.height}, (Rectangle) {0, 0, plasma.width, plasma.height}, 0, WHITE);
+				QueueQuads(&queue, RENDER_LAYER_BACKGROUND, BLEND_ALPHA, &plasmaQuad);
+				SubmitRenderQueue(&queue, &frameArena);
+			}
+
+			EndFrameSection(frameTimer);
+			BeginFrameSection(frameTimer, FRAME_SECTION_SPRITES);
+			DrawSpriteRange(backStars);
+			EndFrameSection(frameTimer);
+			BeginFrameSection(frameTimer, FRAME_SECTION_BACKGROUND);
 
 			// -------------------------------------------------------------------------------------------------------------
 			// Draw copper
-			int scale = VirtualScreen.x / 160;
-            y_offset = 200;
+            float y_offset = 200;
             int plasmaY = 112;
             curve = sin(cos(sin(rastsin )*sin(sinparam * 0.1) * 0.1) * cos(sinparam * 0.015) * 0.1 ) * 0.05 + 0.001;
-			for(int x = 0; x < 160; x++) {
-                for(int y = 10; y >= 0; y--) {
-				DrawTexturePro( copper[y], (Rectangle) { 0, 0, 4, 56 }, (Rectangle) {x*scale, (296/2) + sin(rastsin-rastoffset*(y*5)-(x*curve))*amp+y_offset, scale, plasmaY }, (Vector2) {0}, 0, WHITE );
-                }
+			if (copperMode) {
+				// Same bars as scanline color changes, copper[0] in front, plus the two red rules of bars_data
+				ClearCopperList(copperList);
+				for(int y = 10; y >= 0; y--) {
+					AddCopperBar(copperList, (296/2) + sin(rastsin-rastoffset*(y*5))*amp+y_offset, plasmaY, 10-y, copperGradients[y]);
+				}
+				AddCopperBar(copperList, VirtualScreen.y*0.5 + sin(rastsin*0.7)*(VirtualScreen.y*0.5-12), 12, 11, barsGradient);
+				AddCopperBar(copperList, VirtualScreen.y*0.5 - sin(rastsin*0.7)*(VirtualScreen.y*0.5-12), 12, 11, barsGradient);
+				UpdateCopperList(copperList);
+				DrawCopperList(copperList, (Rectangle) {0, 0, VirtualScreen.x, VirtualScreen.y});
+			} else {
+				QuadList copperQuads = AllocQuadList(&frameArena, copperColumns*copperLayers);
+				EmitCopperColumns(&copperQuads, copper, 11, copperColumns, copperLayers, VirtualScreen.x, rastsin, rastoffset, amp, curve, y_offset, plasmaY);
+				CullQuads(&copperQuads, view, CULL_COPPER, &frameArena);
+				QueueQuads(&queue, RENDER_LAYER_COPPER, BLEND_ALPHA, &copperQuads);
+				SubmitRenderQueue(&queue, &frameArena);
 			}
 
 			// -------------------------------------------------------------------------------------------------------------
 			// Draw Starfield with balle texture
-			Draw_Starfield2D(&starfield6, (Vector2){0,-1});
-			Draw_Starfield2D(&starfield5, (Vector2){0,-1});
-			Draw_Starfield2D(&starfield4, (Vector2){0,-1});
-			Draw_Starfield2D(&starfield3, (Vector2){0,-1});
-			Draw_Starfield2D(&starfield2, (Vector2){0,-1});
-			Draw_Starfield2D(&starfield1, (Vector2){0,-1});
+			EndFrameSection(frameTimer);
+			BeginFrameSection(frameTimer, FRAME_SECTION_SPRITES);
+			DrawSpriteRange(midStars3);
+			DrawSpriteRange(midStars2);
+			DrawSpriteRange(midStars1);
+			EndFrameSection(frameTimer);
+			BeginFrameSection(frameTimer, FRAME_SECTION_QUADS);
 
 			// -------------------------------------------------------------------------------------------------------------
 			// Draw Logo (636x108)
-            Vector2 logosize = {636,108};
-            x_offset = (VirtualScreen.x-logosize.x)*0.5 ;
-            y_offset = 0;
-            
-			for(int i = 0; i < logosize.y; i++) {
-				DrawTexturePro( logo,
-                (Rectangle) { 0, i, logosize.x, 1 }, 
-                (Rectangle) {x_offset+sin(sinparam*0.1 + curve*i)*64 - 32, y_offset+i, logosize.x, 1 }, 
-                (Vector2) { 0, 0 }, 0, WHITE );
-			}
-
+			QuadList logoQuads = AllocQuadList(&frameArena, logoRows);
+			EmitLogoRows(&logoQuads, logo, logoRows, (int)((VirtualScreen.x-logo.width)*0.5), 0, sinparam, curve);
+			CullQuads(&logoQuads, view, CULL_LOGO, &frameArena);
+			QueueQuads(&queue, RENDER_LAYER_LOGO, BLEND_ALPHA, &logoQuads);
 
 			// -------------------------------------------------------------------------------------------------------------
 			// Draw Sine Flag
- 
-            int cell_size = 32;
-
-            x_offset = (VirtualScreen.x-((chars_x+1)*cell_size))*0.5;
-            y_offset = 5 * cell_size;
-            float x_sin = 0;
-            float y_sin = 0;
-            Vector2 cellsize;
-            int char_i = 0;
-            oldsinx = sinx;
-            oldsiny = siny;
-
-			for(int y = 0; y < chars_y; y += 1) {
-				for(int x = 0; x < chars_x; x += 1) {
-                    x_sin = sin(sinx);
-                    y_sin = sin(siny);
-                    grid_pos[y][x].x = (x+x_sin)*cell_size + x_offset;
-                    grid_pos[y][x].y = (y+y_sin)*cell_size + y_offset;
-					siny += 0.2;
-
-                    if (x<(chars_x-1)) {cellsize.x = ((grid_pos[y][x+1].x - grid_pos[y][x].x));} else {cellsize.x = cell_size;};
-                    if (y<(chars_y-1)) {cellsize.y = ((grid_pos[y+1][x].y - grid_pos[y][x].y) + cos(siny)+1.5);} else {cellsize.y = cell_size;};
-                    
-					DrawRectangle(grid_pos[y][x].x, grid_pos[y][x].y, cellsize.x, cellsize.y, (Color) { abs(y_sin*128.0)+127,abs(y_sin*128.0)+127,abs(y_sin*128.0),255 } );
-                    
-                            DrawTexturePro(font2_data,
-                                (Rectangle) {0, (text1[y*32+x] - 32) * 16, 16, 16 },
-                                (Rectangle) {grid_pos[y][x].x, grid_pos[y][x].y , cellsize.x, cellsize.y},
-                                (Vector2) {0},0,(Color) {abs(y_sin*255.0),abs(y_sin*128.0),abs(y_sin*128.0),255});
-                //    sinx +=sin(siny);
-				//	sinx += 0.2;
-				}
-
-				siny += 0.4;  // this is the depth of the waves
-				sinx = oldsinx;
-			}
-
-			siny = oldsiny + 0.02;  // this is the vertical wave movement per frame
+			QuadList flagQuads = AllocQuadList(&frameArena, 2*flag.columns*flag.rows);
+			if (clothMode) EmitClothFlag(&flagQuads, &frameArena, &flag, &cloth, &flagLayer);
+			else EmitSineFlag(&flagQuads, &frameArena, &flag, &flagLayer, VirtualScreen.x);
+			CullQuads(&flagQuads, view, CULL_FLAG, &frameArena);
+			QueueQuads(&queue, RENDER_LAYER_FLAG, BLEND_ALPHA, &flagQuads);
 
 			// -------------------------------------------------------------------------------------------------------------
 			// Draw Copper Bar
-			DrawTextureQuad(copper_bar, (Vector2){80,1}, (Vector2){0},(Rectangle){0,580,VirtualScreen.x,68},WHITE);
+			QuadList barQuad = AllocQuadList(&frameArena, 1);
+			PushTextureQuad(&barQuad, copperBarLayer.target.texture,
+				LayerCacheSource(&copperBarLayer, (Rectangle){0,0,VirtualScreen.x,68}),
+				(Rectangle){0,580,VirtualScreen.x,68}, 0, WHITE);
+			QueueQuads(&queue, RENDER_LAYER_COPPER_BAR, BLEND_ALPHA, &barQuad);
 
 			// -------------------------------------------------------------------------------------------------------------
 			// Draw Scroll Text
-			for(int i=0; i < textLen; i++) {
-				if (scrollTextX + ( i << 5 ) > -32 && scrollTextX + ( i << 5 ) < VirtualScreen.x + 32) {
-					DrawTextureProSK(characters,
-						(Rectangle) { (scrollText[i] - 32) << 5, 0, 32, 32 },
-						(Rectangle) { scrollTextX + (i << 5) , 580, 32, 64 },
-						(Vector2) {32,0},0,WHITE);
-				}
+			QuadList scrollQuads = AllocQuadList(&frameArena, max(STRIP_PAGES, VirtualScreen.x/32 + 4));
+			if (stripScroller) {
+				EmitStripScroller(&scrollQuads, &bigScroller, scrollTextX, 580, 64, VirtualScreen.x, (Vector2) {32,0}, WHITE);
+			} else {
+				EmitSkewScroller(&scrollQuads, &frameArena, &bigFont, &scrollGlyphs, scrollTextX, 580, VirtualScreen.x, (Vector2) {32,0});
 			}
+			CullQuads(&scrollQuads, view, CULL_SCROLLER, &frameArena);
+			QueueQuads(&queue, RENDER_LAYER_SCROLLER, BLEND_ALPHA, &scrollQuads);
             // -------------------------------------------------------------------------------------------------------------
 			// Scroll Text2
-            textX -= GetFrameTime() * 300;
+            textX -= dt * 300;
             if(textX < -textLen2*16 ) textX = VirtualScreen.x;
 
-			for(int i=0; i < textLen2; i++) {
-				if(textX + ( i * 16 + 1 ) < VirtualScreen.x-16 && textX + ( i * 16 + 1 ) > 16) {
-					DrawTexturePro(font2_data,
-						(Rectangle) { 0, (scrollText2[i] - 32) * 16, 16, 16 },
-						(Rectangle) { textX + ( i * 16 + 1 ) , 680 + ySin[i] , 16, 16 },
-						(Vector2) {0,0},ySin[i]*.5, WHITE);
-				}
-			}
-            			Draw_Starfield2D(&starfield0, (Vector2){0,-1});
+			QuadList scroll2Quads = AllocQuadList(&frameArena, textLen2);
+			EmitWaveScroller(&scroll2Quads, &frameArena, &smallFont, &scrollGlyphs2, textX, 680, VirtualScreen.x, ySin, LodValue(&lod, LOD_SCROLLER)*0.5f);
+			CullQuads(&scroll2Quads, view, CULL_SCROLLER2, &frameArena);
+			QueueQuads(&queue, RENDER_LAYER_SCROLLER2, BLEND_ALPHA, &scroll2Quads);
+			SubmitRenderQueue(&queue, &frameArena);
+			EndFrameSection(frameTimer);
+
+			BeginFrameSection(frameTimer, FRAME_SECTION_SPRITES);
+			DrawSpriteRange(frontStars);
+			EndFrameSection(frameTimer);
 
 
 		}
         
+		BeginFrameSection(frameTimer, FRAME_SECTION_QUADS);        // rlgl flushes the last quads here
 		EndTextureMode();
+		EndQuadBatchFrame(&quadBatch);
+		EndFrameSection(frameTimer);
 
+		BeginFrameSection(frameTimer, FRAME_SECTION_CAPTURE);
+		if (capture != NULL) UpdateFrameCapture(capture, frameBuffer, framecount);
+		EndFrameSection(frameTimer);
+
+		BeginFrameSection(frameTimer, FRAME_SECTION_PRESENT);
 		BeginDrawing();
 		{
 			ClearBackground(BLACK);
@@ -427,7 +680,7 @@ int main() {
 			DrawFrameBuffer(frameBuffer);
             
             // debug
-            if (IsKeyDown(KEY_KP_ENTER)) {
+            if (input.keys & INPUT_OVERLAY) {
             DrawText(FormatText("curve %i", (float)curve), 0, 200, 20, DARKGRAY);
             
             DrawText(FormatText("FRAMES=%i", (int)framecount), 0, 0, 20, DARKGRAY);
@@ -439,23 +692,85 @@ int main() {
             DrawText(GetMonitorName(current_monitor), 0, 80, 20, DARKGRAY);
             DrawText(FormatText("screen is %ix%i at %i fps", (int)GetMonitorWidth(current_monitor), (int)GetMonitorHeight(current_monitor), (int)GetMonitorRefreshRate(current_monitor)), 0, 100, 20, DARKGRAY);
             DrawText(FormatText("screen is %ix%i mm", (int)GetMonitorPhysicalWidth(current_monitor), (int)GetMonitorPhysicalHeight(current_monitor)), 0, 120, 20, DARKGRAY);
+            DrawText(FormatText("layer cache hits %i misses %i", layerCacheStats.hits, layerCacheStats.misses), 0, 140, 20, DARKGRAY);
+            DrawText(FormatText("frame arena peak %i KB, %i overflow pages", (int)(frameArena.peak/1024), frameArena.overflowPages), 0, 160, 20, DARKGRAY);
+            DrawText(FormatText("balls %i sprites in %i draw calls (%s)", spriteRenderer.sprites, spriteRenderer.drawCalls, spriteRenderer.instancing ? "instanced" : "per sprite"), 0, 220, 20, DARKGRAY);
+            if (capture != NULL) {
+                CaptureStats captureStats = GetCaptureStats(capture);
+                DrawText(FormatText("capture %i/%i frames, %i dropped, %i in flight (peak %i of %i), copy %.2f ms, encode %.1f ms", captureStats.encoded, captureStats.requested,
+                    captureStats.dropped, captureStats.inFlight, captureStats.peakInFlight, capture->slotCount,
+                    captureStats.captured ? captureStats.copyMs/captureStats.captured : 0.0, captureStats.encoded ? captureStats.encodeMs/captureStats.encoded : 0.0), 0, 240, 20, DARKGRAY);
+            }
+            DrawText(FormatText("render queue %i quads, %i draw calls %i flushes in submission order, %i draw calls %i flushes %s", renderQueueStats.commands,
+                renderQueueStats.drawCallsBefore, renderQueueStats.flushesBefore, renderQueueStats.drawCallsAfter, renderQueueStats.flushesAfter, sortedQueue ? "sorted" : "unsorted (F5)"), 0, 260, 20, DARKGRAY);
+            DrawText(CullStatsText(), 0, 280, 20, DARKGRAY);
+            DrawText(LodText(&lod), 0, 300, 20, DARKGRAY);
+            DrawText(QuadBatchText(&quadBatch), 0, 360, 20, DARKGRAY);
+            if (AllocFrameText() != NULL) DrawText(AllocFrameText(), 0, 340, 20, DARKGRAY);
+            if (clothMode) DrawText(FormatText("cloth %ix%i, %i iterations, %.2f ms on %i threads", cloth.columns, cloth.rows, cloth.iterations, clothMs, pixelPool->threadCount), 0, 320, 20, DARKGRAY);
+            DrawText(FormatText("resources %i KB: %i textures %i KB, %i render textures %i KB, %i streams %i KB", (int)(resourceStats.total/1024),
+                resourceStats.count[RESOURCE_TEXTURE], (int)(resourceStats.bytes[RESOURCE_TEXTURE]/1024),
+                resourceStats.count[RESOURCE_RENDER_TEXTURE], (int)(resourceStats.bytes[RESOURCE_RENDER_TEXTURE]/1024),
+                resourceStats.count[RESOURCE_MUSIC], (int)(resourceStats.bytes[RESOURCE_MUSIC]/1024)), 0, 180, 20, DARKGRAY);
             }
 
-            if (IsKeyDown(KEY_FOUR) & IsKeyDown(KEY_ZERO) & IsKeyDown(KEY_ONE)) {
+            if ((input.keys & INPUT_EXIT) == INPUT_EXIT) {
             stay_in_loop = false;
             }
 
 		}
+		lodWork = GetTime() - frameStart;
 		EndDrawing();
+		EndFrameSection(frameTimer);
+		if (startup != NULL) { ReportStartup(startup); startup = NULL; }
         
         framecount++;
 
 	}
 
-	UnloadRenderTexture(frameBuffer);
-	UnloadMusicStream(music);
+	if (!FinishAllocTracking() && allocConfig.check) exitCode = 1;
+	if (capture != NULL && UnloadFrameCapture(capture).mismatched > 0) exitCode = 1;     // headless golden runs
+	if (stressSweep != NULL) CloseStressSweep(stressSweep);
+	if (replay != NULL) CloseReplay(replay);
+	if (frameTimer != NULL) {
+		if (!WriteFrameTimeReport(frameTimer, stressScale, STRESS_EFFECTS)) exitCode = 1;
+		UnloadFrameTimer(frameTimer);
+	}
+	for (int i = 0; i < 8; i++) Unload_Starfield2D(starfields[i]);
+	UnloadSpriteBatch(&balls3);
+	UnloadSpriteBatch(&balls2);
+	UnloadSpriteBatch(&balls1);
+	CloseSpriteRenderer();
+	UnloadQuadBatch(&quadBatch);
+	UnloadStripScroller(&bigScroller);
+	UnloadBitmapText(&scrollGlyphs2);
+	UnloadBitmapText(&scrollGlyphs);
+	UnloadBitmapText(&flagGlyphs);
+	FreeFrameArena(&frameArena);
+	UnloadLayerCache(&copperBarLayer);
+	UnloadLayerCache(&flagLayer);
+	UnloadClothFlag(&cloth);
+	UnloadTrackedRenderTexture(frameBuffer);
+	UnloadMusicTrack(&music);
+
+	UnloadTrackedTexture(plasmaTexture);
+	UnloadPixelBuffer(&plasma);
+	if (pixelPool != NULL) UnloadPixelPool(pixelPool);
+	if (copperList != NULL) UnloadCopperList(copperList);
+	if (assets != NULL) CloseAssetPack(assets);
+	for(int i = 0; i < 11; i++) UnloadTrackedTexture(copper[i]);
+	UnloadTrackedTexture(copper_bar);
+	UnloadTrackedTexture(logo);
+	UnloadTrackedTexture(characters);
+	UnloadTrackedTexture(font2_data);
+	UnloadTrackedTexture(balle1);
+	UnloadTrackedTexture(balle2);
+	UnloadTrackedTexture(balle3);
+
+	ReportResources();
+	CloseAudioDevice();
 	CloseWindow();
-	return 0;
+	return exitCode;
 }
 
 // -------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,300 @@
+#ifndef __PCMCACHE_H__
+#define __PCMCACHE_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "resources.h"
+#include "tracker.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// PCM cache for the music
+// A music stream decodes Vorbis for as long as it plays, every loop of the track. With the cache the track is
+// decoded once to PCM and played from there: the stream is fed by copying, with no decoding.
+//
+//     --music-cache memory     decodes at every start and keeps the PCM in memory (about 10 MB a minute)
+//     --music-cache disk       decodes on the first start into cache/<hash of the file>.pcm, then maps it
+//     --music-cache-dir dir    where disk caches go
+//
+// The disk cache is keyed by a hash of the ogg file, so a new track is decoded again; the old file stays.
+// A tracker module (tracker.h) plays through the same MusicTrack, mixed instead of decoded.
+
+#define PCM_CACHE_MAGIC "DPCM"
+#define PCM_CACHE_VERSION 1
+#define PCM_CACHE_DATA 4096             // samples start on their own page
+#define PCM_STREAM_FRAMES RESOURCE_STREAM_FRAMES
+
+typedef enum { MUSIC_CACHE_OFF = 0, MUSIC_CACHE_MEMORY, MUSIC_CACHE_DISK, MUSIC_MODULE } MusicCacheMode;
+
+typedef struct MusicCacheConfig {
+	MusicCacheMode mode;
+	const char *directory;
+} MusicCacheConfig;
+
+typedef struct PcmCacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceHash;            // FNV-1a of the whole source file
+	uint32_t sampleRate;
+	uint32_t sampleSize;            // bits
+	uint32_t channels;
+	uint32_t frames;
+} PcmCacheHeader;
+
+typedef struct PcmTrack {
+	const unsigned char *samples;   // interleaved
+	unsigned int frames;
+	unsigned int sampleRate;
+	unsigned int sampleSize;
+	unsigned int channels;
+	void *memory;                   // decoded wave, memory mode
+	void *map;                      // mapped cache file, disk mode
+	size_t mapSize;
+} PcmTrack;
+
+// The music, played from a stream, from a PCM track or from a tracker module
+typedef struct MusicTrack {
+	MusicCacheMode mode;
+	Music music;
+	PcmTrack pcm;
+	AudioStream stream;
+	unsigned int cursor;            // next frame to queue
+	unsigned char *wrap;            // one buffer of frames across the end of the track
+	TrackerStream *module;
+} MusicTrack;
+
+static MusicCacheConfig ParseMusicCacheArgs(int argc, char **argv) {
+	MusicCacheConfig config = { MUSIC_CACHE_OFF, "cache" };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--music-cache") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "memory") == 0) config.mode = MUSIC_CACHE_MEMORY;
+			else if (strcmp(argv[i], "disk") == 0) config.mode = MUSIC_CACHE_DISK;
+			else config.mode = MUSIC_CACHE_OFF;
+		} else if (strcmp(argv[i], "--music-cache-dir") == 0 && i + 1 < argc) {
+			config.directory = argv[++i];
+		}
+	}
+	return config;
+}
+
+static uint64_t HashPcmSource(const char *fileName) {
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL) return 0;
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	unsigned char block[65536];
+	size_t n;
+	while ((n = fread(block, 1, sizeof(block), file)) > 0) {
+		for (size_t i = 0; i < n; i++) hash = (hash ^ block[i])*0x100000001b3ULL;
+	}
+	fclose(file);
+	return hash;
+}
+
+static size_t PcmTrackBytes(const PcmTrack *track) {
+	return (size_t)track->frames*track->channels*(track->sampleSize/8);
+}
+
+static bool DecodePcmTrack(const char *fileName, PcmTrack *track) {
+	Wave wave = LoadWave(fileName);
+	if (wave.data == NULL || wave.sampleCount == 0) return false;
+
+	// raylib 3.5 counts samples of all channels in sampleCount
+	*track = (PcmTrack) { (const unsigned char *)wave.data, wave.sampleCount/wave.channels, wave.sampleRate, wave.sampleSize, wave.channels, wave.data, NULL, 0 };
+	return true;
+}
+
+static bool MapPcmCache(const char *path, uint64_t hash, PcmTrack *track) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	void *map = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && (size_t)st.st_size >= PCM_CACHE_DATA) map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return false;
+
+	const PcmCacheHeader *h = (const PcmCacheHeader *)map;
+	PcmTrack t = { (const unsigned char *)map + PCM_CACHE_DATA, h->frames, h->sampleRate, h->sampleSize, h->channels, NULL, map, (size_t)st.st_size };
+	bool valid = memcmp(h->magic, PCM_CACHE_MAGIC, 4) == 0 && h->version == PCM_CACHE_VERSION && h->sourceHash == hash &&
+		h->channels > 0 && (h->sampleSize == 16 || h->sampleSize == 32) && PCM_CACHE_DATA + PcmTrackBytes(&t) <= (size_t)st.st_size;
+	if (!valid) {
+		munmap(map, st.st_size);
+		return false;
+	}
+
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+	*track = t;
+	return true;
+}
+
+// Writes next to the final name, then renames, so a cache is either whole or missing
+static bool WritePcmCache(const char *path, uint64_t hash, const PcmTrack *track) {
+	char temp[520];
+	snprintf(temp, sizeof(temp), "%s.tmp", path);
+	FILE *file = fopen(temp, "wb");
+	if (file == NULL) return false;
+
+	PcmCacheHeader header = { { 'D', 'P', 'C', 'M' }, PCM_CACHE_VERSION, hash, track->sampleRate, track->sampleSize, track->channels, track->frames };
+	unsigned char page[PCM_CACHE_DATA] = { 0 };
+	memcpy(page, &header, sizeof(header));
+	bool ok = fwrite(page, 1, sizeof(page), file) == sizeof(page) && fwrite(track->samples, 1, PcmTrackBytes(track), file) == PcmTrackBytes(track);
+	if (fclose(file) != 0) ok = false;
+	if (ok) ok = rename(temp, path) == 0;
+	if (!ok) remove(temp);
+	return ok;
+}
+
+static bool LoadPcmTrack(const char *fileName, MusicCacheConfig config, PcmTrack *track) {
+	if (config.mode == MUSIC_CACHE_MEMORY) return DecodePcmTrack(fileName, track);
+
+	uint64_t hash = HashPcmSource(fileName);
+	if (hash == 0) return false;
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%016llx.pcm", config.directory, (unsigned long long)hash);
+	if (MapPcmCache(path, hash, track)) return true;
+
+	TraceLog(LOG_INFO, "MUSIC: decoding %s into %s", fileName, path);
+	PcmTrack decoded;
+	if (!DecodePcmTrack(fileName, &decoded)) return false;
+	mkdir(config.directory, 0755);
+	bool written = WritePcmCache(path, hash, &decoded);
+	if (written && MapPcmCache(path, hash, track)) {
+		free(decoded.memory);
+		return true;
+	}
+
+	// No cache on disk, play from memory this time
+	TraceLog(LOG_WARNING, "MUSIC: could not write %s, keeping the track in memory", path);
+	*track = decoded;
+	return true;
+}
+
+static void UnloadPcmTrack(PcmTrack *track) {
+	if (track->map != NULL) munmap(track->map, track->mapSize);
+	free(track->memory);
+	*track = (PcmTrack) { 0 };
+}
+
+// 'frames' frames from the cursor, looping over the end of the track; points into the track unless it wraps
+static const void *ReadPcmFrames(MusicTrack *track, unsigned int frames) {
+	const PcmTrack *pcm = &track->pcm;
+	size_t frameBytes = (size_t)pcm->channels*(pcm->sampleSize/8);
+	const unsigned char *data;
+
+	if (track->cursor + frames <= pcm->frames) {
+		data = pcm->samples + track->cursor*frameBytes;
+		track->cursor += frames;
+	} else {
+		unsigned int done = 0;
+		while (done < frames) {
+			unsigned int n = pcm->frames - track->cursor;
+			if (n > frames - done) n = frames - done;
+			memcpy(track->wrap + done*frameBytes, pcm->samples + track->cursor*frameBytes, n*frameBytes);
+			done += n;
+			track->cursor += n;
+			if (track->cursor == pcm->frames) track->cursor = 0;
+		}
+		data = track->wrap;
+	}
+	if (track->cursor == pcm->frames) track->cursor = 0;
+	return data;
+}
+
+// Falls back to the stream when the cache is off or the track could not be cached
+static MusicTrack LoadMusicTrack(const char *fileName, MusicCacheConfig config) {
+	MusicTrack track = { MUSIC_CACHE_OFF };
+
+	if (config.mode != MUSIC_CACHE_OFF && LoadPcmTrack(fileName, config, &track.pcm) && track.pcm.frames >= PCM_STREAM_FRAMES) {
+		SetAudioStreamBufferSizeDefault(PCM_STREAM_FRAMES);
+		track.stream = InitAudioStream(track.pcm.sampleRate, track.pcm.sampleSize, track.pcm.channels);
+		track.wrap = (unsigned char *)malloc((size_t)PCM_STREAM_FRAMES*track.pcm.channels*(track.pcm.sampleSize/8));
+		track.mode = (track.pcm.memory != NULL) ? MUSIC_CACHE_MEMORY : MUSIC_CACHE_DISK;
+
+		size_t bytes = (size_t)PCM_STREAM_FRAMES*2*track.pcm.channels*(track.pcm.sampleSize/8);
+		if (track.mode == MUSIC_CACHE_MEMORY) bytes += PcmTrackBytes(&track.pcm);      // the mapping is page cache
+		TrackResource(RESOURCE_MUSIC, 0, track.wrap, fileName, bytes);
+		TraceLog(LOG_INFO, "MUSIC: %s from %s PCM, %.1f s, %i KB", fileName, track.mode == MUSIC_CACHE_MEMORY ? "memory" : "disk",
+			(float)track.pcm.frames/track.pcm.sampleRate, (int)(PcmTrackBytes(&track.pcm)/1024));
+		return track;
+	}
+
+	UnloadPcmTrack(&track.pcm);
+	track.music = LoadTrackedMusic(fileName);
+	return track;
+}
+
+// A MOD or XM in memory; not ready when it does not load, the caller falls back to the ogg
+static MusicTrack LoadModuleTrack(const unsigned char *data, size_t size, const char *name) {
+	MusicTrack track = { MUSIC_CACHE_OFF };
+	TrackerStream *module = LoadTrackerStream(data, size, TRACKER_RATE, PCM_STREAM_FRAMES);
+	if (module == NULL) {
+		TraceLog(LOG_WARNING, "MUSIC: %s could not be loaded as a MOD or XM module", name);
+		return track;
+	}
+
+	SetAudioStreamBufferSizeDefault(PCM_STREAM_FRAMES);
+	track.stream = InitAudioStream(TRACKER_RATE, 16, 2);
+	track.mode = MUSIC_MODULE;
+	track.module = module;
+	TrackResource(RESOURCE_MUSIC, 0, module, name, TrackerStreamBytes(module));
+	return track;
+}
+
+static bool MusicTrackReady(const MusicTrack *track) {
+	if (track->mode == MUSIC_MODULE) return track->module != NULL;
+	return (track->mode == MUSIC_CACHE_OFF) ? track->music.ctxData != NULL : track->wrap != NULL;
+}
+
+static void PlayMusicTrack(MusicTrack *track) {
+	if (track->mode == MUSIC_CACHE_OFF) PlayMusicStream(track->music);
+	else PlayAudioStream(track->stream);
+}
+
+static void UpdateMusicTrack(MusicTrack *track) {
+	if (track->mode == MUSIC_CACHE_OFF) {
+		UpdateMusicStream(track->music);
+		return;
+	}
+	if (track->mode == MUSIC_MODULE) {
+		while (IsAudioStreamProcessed(track->stream)) {
+			UpdateAudioStream(track->stream, AcquireTrackerBuffer(track->module), PCM_STREAM_FRAMES*2);
+			ReleaseTrackerBuffer(track->module);
+		}
+		return;
+	}
+	while (IsAudioStreamProcessed(track->stream)) {
+		UpdateAudioStream(track->stream, ReadPcmFrames(track, PCM_STREAM_FRAMES), PCM_STREAM_FRAMES*track->pcm.channels);
+	}
+}
+
+static void UnloadMusicTrack(MusicTrack *track) {
+	if (track->mode == MUSIC_CACHE_OFF) {
+		UnloadTrackedMusic(track->music);
+		return;
+	}
+	if (track->mode == MUSIC_MODULE) {
+		UntrackResource(RESOURCE_MUSIC, 0, track->module);
+		CloseAudioStream(track->stream);
+		UnloadTrackerStream(track->module);
+		track->module = NULL;
+		return;
+	}
+	UntrackResource(RESOURCE_MUSIC, 0, track->wrap);
+	CloseAudioStream(track->stream);
+	UnloadPcmTrack(&track->pcm);
+	free(track->wrap);
+	track->wrap = NULL;
+}
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef __PIXELFX_H__
+#define __PIXELFX_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------
+// CPU pixel effects
+// Effects that write straight into an RGBA pixel buffer. A kernel fills a band of rows; RunPixelKernel() splits
+// the buffer in bands and runs them on a small thread pool (the calling thread helps). The caller uploads the
+// buffer into a texture with UpdateTexture() and composites it into the frame buffer like any other sprite.
+
+#define PIXEL_MAX_THREADS 64
+#define PIXEL_BAND_ROWS 8
+
+typedef struct PixelBuffer {
+	int width;
+	int height;
+	Color *pixels;          // 32 byte aligned, rows are contiguous
+} PixelBuffer;
+
+typedef void (*PixelKernel)(PixelBuffer *buffer, int y0, int y1, const void *params);
+
+typedef struct PixelPool {
+	int threadCount;        // calling thread included
+	pthread_t threads[PIXEL_MAX_THREADS];
+	pthread_mutex_t mutex;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	int generation;
+	int active;
+	bool quit;
+
+	PixelKernel kernel;
+	PixelBuffer *buffer;
+	const void *params;
+	int bands;
+	int nextBand;
+} PixelPool;
+
+// pixels is NULL, and the size 0x0, when the buffer could not be allocated
+static PixelBuffer LoadPixelBuffer(int width, int height) {
+	PixelBuffer buffer = { width, height, NULL };
+	size_t size = ((size_t)width*height*sizeof(Color) + 31) & ~(size_t)31;
+	buffer.pixels = (Color *)aligned_alloc(32, size);
+	if (buffer.pixels == NULL) {
+		TraceLog(LOG_WARNING, "PIXELS: could not allocate a %ix%i buffer", width, height);
+		return (PixelBuffer) { 0 };
+	}
+	memset(buffer.pixels, 0, size);
+	return buffer;
+}
+
+static void UnloadPixelBuffer(PixelBuffer *buffer) {
+	free(buffer->pixels);
+	buffer->pixels = NULL;
+}
+
+static void RunPixelBands(PixelPool *pool) {
+	int bands = pool->bands;
+	int height = pool->buffer->height;
+	for (;;) {
+		int band = __atomic_fetch_add(&pool->nextBand, 1, __ATOMIC_RELAXED);
+		if (band >= bands) break;
+		int y0 = band*PIXEL_BAND_ROWS;
+		int y1 = y0 + PIXEL_BAND_ROWS;
+		if (y1 > height) y1 = height;
+		pool->kernel(pool->buffer, y0, y1, pool->params);
+	}
+}
+
+static void *PixelWorker(void *arg) {
+	PixelPool *pool = (PixelPool *)arg;
+	int seen = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->mutex);
+		while (pool->generation == seen && !pool->quit) pthread_cond_wait(&pool->start, &pool->mutex);
+		if (pool->quit) { pthread_mutex_unlock(&pool->mutex); break; }
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+
+		RunPixelBands(pool);
+
+		pthread_mutex_lock(&pool->mutex);
+		if (--pool->active == 0) pthread_cond_signal(&pool->done);
+		pthread_mutex_unlock(&pool->mutex);
+	}
+	return NULL;
+}
+
+// threads <= 0 uses one thread per online core, NULL when the pool could not be allocated
+static PixelPool *LoadPixelPool(int threads) {
+	if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads < 1) threads = 1;
+	if (threads > PIXEL_MAX_THREADS) threads = PIXEL_MAX_THREADS;
+
+	PixelPool *pool = (PixelPool *)calloc(1, sizeof(PixelPool));
+	if (pool == NULL) {
+		TraceLog(LOG_WARNING, "PIXELS: could not allocate a pool of %i threads", threads);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+
+	pool->threadCount = 1;
+	for (int i = 1; i < threads; i++) {
+		if (pthread_create(&pool->threads[i], NULL, PixelWorker, pool) != 0) break;
+		pool->threadCount++;
+	}
+	return pool;
+}
+
+static void UnloadPixelPool(PixelPool *pool) {
+	pthread_mutex_lock(&pool->mutex);
+	pool->quit = true;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (int i = 1; i < pool->threadCount; i++) pthread_join(pool->threads[i], NULL);
+
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->start);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+// Runs a kernel over the whole buffer and returns once every row is written
+static void RunPixelKernel(PixelPool *pool, PixelBuffer *buffer, PixelKernel kernel, const void *params) {
+	pool->kernel = kernel;
+	pool->buffer = buffer;
+	pool->params = params;
+	pool->bands = (buffer->height + PIXEL_BAND_ROWS - 1)/PIXEL_BAND_ROWS;
+	pool->nextBand = 0;
+
+	if (pool->threadCount == 1) {
+		RunPixelBands(pool);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->active = pool->threadCount - 1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->mutex);
+
+	RunPixelBands(pool);
+
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->active > 0) pthread_cond_wait(&pool->done, &pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Plasma
+// Classic table plasma, made separable so rows vectorize: v = columnWave[x] + diagonalWave[x + y] + rowWave[y]
+// (all bytes, wrapping), then each channel is a triangle wave of v shifted by a third of the period.
+
+typedef struct PlasmaParams {
+	unsigned char *columnWave;      // width bytes
+	unsigned char *diagonalWave;    // width + height bytes
+	unsigned char *rowWave;         // height bytes
+	unsigned char alpha;
+} PlasmaParams;
+
+static unsigned char plasmaSin[256];
+
+static void InitPlasma(void) {
+	for (int i = 0; i < 256; i++) plasmaSin[i] = (unsigned char)(127.5f + 127.5f*sinf(i*2.0f*PI/256.0f));
+}
+
+// Per frame wave tables, the buffers come from the caller (frame arena)
+static PlasmaParams PreparePlasma(int width, int height, float time, unsigned char *columnWave, unsigned char *diagonalWave, unsigned char *rowWave) {
+	PlasmaParams p = { columnWave, diagonalWave, rowWave, 255 };
+	int t = (int)(time*60.0f);
+
+	for (int x = 0; x < width; x++) p.columnWave[x] = (plasmaSin[(x/4 + t) & 255] + plasmaSin[(x/7 - t*2) & 255]) >> 1;
+	for (int i = 0; i < width + height; i++) p.diagonalWave[i] = plasmaSin[(i/5 + t*3) & 255] >> 1;
+	for (int y = 0; y < height; y++) p.rowWave[y] = plasmaSin[(y/3 - t) & 255] + plasmaSin[(y/9 + t) & 255];
+	return p;
+}
+
+static inline unsigned char PlasmaTriangle(unsigned char v) {
+	unsigned char t = (v & 0x80) ? (unsigned char)~v : v;
+	return (unsigned char)(t << 1);
+}
+
+// Scalar reference, also used for the tail of each row
+static void PlasmaPixels(const PlasmaParams *p, Color *row, int y, int x0, int x1) {
+	for (int x = x0; x < x1; x++) {
+		unsigned char v = p->columnWave[x] + p->diagonalWave[x + y] + p->rowWave[y];
+		row[x] = (Color) { PlasmaTriangle(v), PlasmaTriangle(v + 85), PlasmaTriangle(v + 170), p->alpha };
+	}
+}
+
+#if defined(__SSE2__)
+static inline __m128i PlasmaTriangle16(__m128i v) {
+	__m128i sign = _mm_cmplt_epi8(v, _mm_setzero_si128());     // v >= 128 as unsigned
+	__m128i t = _mm_xor_si128(v, sign);
+	return _mm_add_epi8(t, t);
+}
+#endif
+
+static void PlasmaKernel(PixelBuffer *buffer, int y0, int y1, const void *params) {
+	const PlasmaParams *p = (const PlasmaParams *)params;
+	int width = buffer->width;
+
+	for (int y = y0; y < y1; y++) {
+		Color *row = buffer->pixels + (size_t)y*width;
+		int x = 0;
+
+#if defined(__SSE2__)
+		__m128i rowValue = _mm_set1_epi8((char)p->rowWave[y]);
+		__m128i shiftG = _mm_set1_epi8(85);
+		__m128i shiftB = _mm_set1_epi8((char)170);
+		__m128i alpha = _mm_set1_epi8((char)p->alpha);
+
+		for (; x + 16 <= width; x += 16) {
+			__m128i v = _mm_add_epi8(_mm_loadu_si128((const __m128i *)(p->columnWave + x)),
+				_mm_loadu_si128((const __m128i *)(p->diagonalWave + x + y)));
+			v = _mm_add_epi8(v, rowValue);
+
+			__m128i r = PlasmaTriangle16(v);
+			__m128i g = PlasmaTriangle16(_mm_add_epi8(v, shiftG));
+			__m128i b = PlasmaTriangle16(_mm_add_epi8(v, shiftB));
+
+			__m128i rgLo = _mm_unpacklo_epi8(r, g), rgHi = _mm_unpackhi_epi8(r, g);
+			__m128i baLo = _mm_unpacklo_epi8(b, alpha), baHi = _mm_unpackhi_epi8(b, alpha);
+
+			__m128i *out = (__m128i *)(row + x);
+			_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rgLo, baLo));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rgLo, baLo));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rgHi, baHi));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rgHi, baHi));
+		}
+#endif
+
+		PlasmaPixels(p, row, y, x, width);
+	}
+}
+
+// Same result without SIMD, to check the kernel against
+static void PlasmaKernelScalar(PixelBuffer *buffer, int y0, int y1, const void *params) {
+	const PlasmaParams *p = (const PlasmaParams *)params;
+	for (int y = y0; y < y1; y++) PlasmaPixels(p, buffer->pixels + (size_t)y*buffer->width, y, 0, buffer->width);
+}
+
+#endif
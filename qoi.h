@@ -0,0 +1,294 @@
+#ifndef __QOI_H__
+#define __QOI_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------
+// QOI images
+// Lossless "Quite OK Image" format (qoiformat.org), an order of magnitude faster than PNG to write, used for
+// frame captures and golden images. The encoder hashes pixels in blocks with SIMD and finds runs four pixels
+// at a time; the byte stream is the reference one, any QOI reader opens the files.
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+#define QOI_OP_RGBA 0xff
+#define QOI_HEADER_SIZE 14
+#define QOI_PADDING_SIZE 8
+#define QOI_BLOCK 256           // pixels hashed at once
+
+typedef struct QoiDiff {
+	bool loaded;                // golden read and same size
+	int mismatched;             // pixels differing by more than the tolerance
+	int maxDelta;               // largest channel difference
+} QoiDiff;
+
+static inline unsigned int QoiHash(Color c) {
+	return (c.r*3 + c.g*5 + c.b*7 + c.a*11) & 63;
+}
+
+static inline bool QoiEqual(Color a, Color b) {
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// Index slot of 'count' pixels
+static void QoiHashes(const Color *pixels, unsigned char *hashes, int count) {
+	int i = 0;
+#if defined(__SSE2__)
+	const __m128i weights = _mm_setr_epi16(3, 5, 7, 11, 3, 5, 7, 11);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= count; i += 4) {
+		__m128i p = _mm_loadu_si128((const __m128i *)(pixels + i));
+		__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), weights);     // 3r+5g, 7b+11a of pixels 0, 1
+		__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(p, zero), weights);     // same for pixels 2, 3
+		__m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+		__m128i sum = _mm_and_si128(_mm_add_epi32(even, odd), _mm_set1_epi32(63));
+		sum = _mm_packs_epi32(sum, sum);
+		sum = _mm_packus_epi16(sum, sum);
+		int packed = _mm_cvtsi128_si32(sum);
+		memcpy(hashes + i, &packed, 4);
+	}
+#endif
+	for (; i < count; i++) hashes[i] = (unsigned char)QoiHash(pixels[i]);
+}
+
+// Pixels from 'pixels' equal to 'value', up to 'count'
+static int QoiRunLength(const Color *pixels, Color value, int count) {
+	int n = 0;
+#if defined(__SSE2__)
+	unsigned int v;
+	memcpy(&v, &value, 4);
+	__m128i broadcast = _mm_set1_epi32((int)v);
+	for (; n + 4 <= count; n += 4) {
+		__m128i p = _mm_loadu_si128((const __m128i *)(pixels + n));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(p, broadcast)) != 0xffff) break;
+	}
+#endif
+	while (n < count && QoiEqual(pixels[n], value)) n++;
+	return n;
+}
+
+static unsigned char *QoiWriteRun(unsigned char *p, int run) {
+	for (; run >= 62; run -= 62) *p++ = QOI_OP_RUN | 61;
+	if (run > 0) *p++ = QOI_OP_RUN | (run - 1);
+	return p;
+}
+
+static size_t QoiMaxSize(int width, int height) {
+	return QOI_HEADER_SIZE + (size_t)width*height*5 + QOI_PADDING_SIZE;
+}
+
+static void QoiWrite32(unsigned char *p, unsigned int v) {
+	p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static unsigned int QoiRead32(const unsigned char *p) {
+	return (unsigned int)p[0] << 24 | (unsigned int)p[1] << 16 | (unsigned int)p[2] << 8 | p[3];
+}
+
+// Encodes RGBA pixels, top row first, into 'out' (QoiMaxSize() bytes) and returns the size written
+static size_t EncodeQoi(const Color *pixels, int width, int height, unsigned char *out) {
+	unsigned char *p = out;
+	memcpy(p, "qoif", 4);
+	QoiWrite32(p + 4, width);
+	QoiWrite32(p + 8, height);
+	p[12] = 4;      // RGBA
+	p[13] = 0;      // sRGB
+	p += QOI_HEADER_SIZE;
+
+	Color index[64];
+	memset(index, 0, sizeof(index));
+	Color prev = { 0, 0, 0, 255 };
+	unsigned char hashes[QOI_BLOCK];
+	int total = width*height;
+	int run = 0;            // runs carry over block boundaries
+
+	for (int block = 0; block < total; block += QOI_BLOCK) {
+		int count = (total - block < QOI_BLOCK) ? total - block : QOI_BLOCK;
+		const Color *px = pixels + block;
+		QoiHashes(px, hashes, count);
+
+		for (int i = 0; i < count; ) {
+			Color c = px[i];
+
+			if (QoiEqual(c, prev)) {
+				int n = QoiRunLength(px + i, prev, count - i);
+				run += n;
+				i += n;
+				continue;
+			}
+			if (run > 0) { p = QoiWriteRun(p, run); run = 0; }
+
+			unsigned int h = hashes[i];
+			if (QoiEqual(index[h], c)) {
+				*p++ = QOI_OP_INDEX | h;
+			} else {
+				index[h] = c;
+				if (c.a == prev.a) {
+					signed char vr = (signed char)(c.r - prev.r);
+					signed char vg = (signed char)(c.g - prev.g);
+					signed char vb = (signed char)(c.b - prev.b);
+					signed char vgr = (signed char)(vr - vg);
+					signed char vgb = (signed char)(vb - vg);
+
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+						*p++ = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+					} else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+						*p++ = QOI_OP_LUMA | (vg + 32);
+						*p++ = (vgr + 8) << 4 | (vgb + 8);
+					} else {
+						*p++ = QOI_OP_RGB; *p++ = c.r; *p++ = c.g; *p++ = c.b;
+					}
+				} else {
+					*p++ = QOI_OP_RGBA; *p++ = c.r; *p++ = c.g; *p++ = c.b; *p++ = c.a;
+				}
+			}
+			prev = c;
+			i++;
+		}
+	}
+	p = QoiWriteRun(p, run);
+
+	static const unsigned char padding[QOI_PADDING_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+	memcpy(p, padding, QOI_PADDING_SIZE);
+	p += QOI_PADDING_SIZE;
+	return (size_t)(p - out);
+}
+
+static bool ReadQoiHeader(const unsigned char *data, size_t size, int *width, int *height) {
+	if (size < QOI_HEADER_SIZE + QOI_PADDING_SIZE || memcmp(data, "qoif", 4) != 0) return false;
+	*width = (int)QoiRead32(data + 4);
+	*height = (int)QoiRead32(data + 8);
+	return *width > 0 && *height > 0 && (size_t)*width*(size_t)*height < (1u << 28);
+}
+
+// Decodes into 'pixels' (width*height from the header), RGB files get an opaque alpha
+static bool DecodeQoi(const unsigned char *data, size_t size, Color *pixels) {
+	int width, height;
+	if (!ReadQoiHeader(data, size, &width, &height)) return false;
+
+	Color index[64];
+	memset(index, 0, sizeof(index));
+	Color c = { 0, 0, 0, 255 };
+	const unsigned char *p = data + QOI_HEADER_SIZE;
+	const unsigned char *end = data + size - QOI_PADDING_SIZE;
+	int total = width*height;
+
+	for (int i = 0; i < total; ) {
+		if (p >= end) return false;
+		int b = *p++;
+
+		if (b == QOI_OP_RGB) {
+			c.r = p[0]; c.g = p[1]; c.b = p[2];
+			p += 3;
+		} else if (b == QOI_OP_RGBA) {
+			c.r = p[0]; c.g = p[1]; c.b = p[2]; c.a = p[3];
+			p += 4;
+		} else if ((b & 0xc0) == QOI_OP_INDEX) {
+			c = index[b];
+		} else if ((b & 0xc0) == QOI_OP_DIFF) {
+			c.r += ((b >> 4) & 3) - 2;
+			c.g += ((b >> 2) & 3) - 2;
+			c.b += (b & 3) - 2;
+		} else if ((b & 0xc0) == QOI_OP_LUMA) {
+			int vg = (b & 0x3f) - 32;
+			int b2 = *p++;
+			c.r += vg - 8 + ((b2 >> 4) & 0x0f);
+			c.g += vg;
+			c.b += vg - 8 + (b2 & 0x0f);
+		} else {
+			int run = (b & 0x3f) + 1;
+			if (run > total - i) run = total - i;
+			for (int k = 0; k < run; k++) pixels[i + k] = c;
+			i += run;
+			continue;
+		}
+
+		index[QoiHash(c)] = c;
+		pixels[i++] = c;
+	}
+	return true;
+}
+
+static bool SaveQoi(const char *fileName, const Color *pixels, int width, int height) {
+	unsigned char *data = (unsigned char *)malloc(QoiMaxSize(width, height));
+	if (data == NULL) return false;
+
+	size_t size = EncodeQoi(pixels, width, height, data);
+	FILE *file = fopen(fileName, "wb");
+	bool saved = file != NULL && fwrite(data, 1, size, file) == size;
+	if (file != NULL) fclose(file);
+	free(data);
+
+	if (!saved) TraceLog(LOG_WARNING, "QOI: could not write %s", fileName);
+	return saved;
+}
+
+// Returns malloc'd pixels, NULL if the file is missing or broken
+static Color *LoadQoi(const char *fileName, int *width, int *height) {
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL) return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	unsigned char *data = (size > 0) ? (unsigned char *)malloc(size) : NULL;
+	bool read = data != NULL && fread(data, 1, size, file) == (size_t)size;
+	fclose(file);
+
+	Color *pixels = NULL;
+	if (read && ReadQoiHeader(data, size, width, height)) {
+		pixels = (Color *)malloc((size_t)*width*(*height)*sizeof(Color));
+		if (!DecodeQoi(data, size, pixels)) { free(pixels); pixels = NULL; }
+	}
+	free(data);
+	if (pixels == NULL) TraceLog(LOG_WARNING, "QOI: could not read %s", fileName);
+	return pixels;
+}
+
+// Pixel by pixel comparison, identical rows are skipped with memcmp
+static QoiDiff CompareQoiPixels(const Color *a, const Color *b, int width, int height, int tolerance) {
+	QoiDiff diff = { true, 0, 0 };
+	size_t stride = (size_t)width*sizeof(Color);
+
+	for (int y = 0; y < height; y++) {
+		const Color *ra = a + (size_t)y*width, *rb = b + (size_t)y*width;
+		if (memcmp(ra, rb, stride) == 0) continue;
+
+		for (int x = 0; x < width; x++) {
+			int d = abs(ra[x].r - rb[x].r);
+			int dg = abs(ra[x].g - rb[x].g), db = abs(ra[x].b - rb[x].b), da = abs(ra[x].a - rb[x].a);
+			if (dg > d) d = dg;
+			if (db > d) d = db;
+			if (da > d) d = da;
+			if (d > diff.maxDelta) diff.maxDelta = d;
+			if (d > tolerance) diff.mismatched++;
+		}
+	}
+	return diff;
+}
+
+static QoiDiff CompareQoiGolden(const Color *pixels, int width, int height, const char *golden, int tolerance) {
+	QoiDiff diff = { false, 0, 0 };
+	int goldenWidth, goldenHeight;
+	Color *reference = LoadQoi(golden, &goldenWidth, &goldenHeight);
+	if (reference == NULL) return diff;
+
+	if (goldenWidth == width && goldenHeight == height) diff = CompareQoiPixels(pixels, reference, width, height, tolerance);
+	free(reference);
+	return diff;
+}
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef __QUADBATCH_H__
+#define __QUADBATCH_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rlgl.h"
+#include "effects.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Quad batch
+// The render queue's own vertex batch, in place of rlgl's: raylib 3.5 keeps its batch internal, sized at build
+// time (DEFAULT_BATCH_BUFFER_ELEMENTS quads, one buffer) and flushed whenever it fills up. This one is a ring
+// of QUAD_BATCH_BUFFERS vertex buffers, each flush filling the next so the GPU can still read the last ones,
+// and it counts why it flushed: the buffer filled up (overflow), the draw list filled up, or the queue was
+// submitted because something outside it draws next. The largest run of quads between the last two is
+// measured each frame; a frame that overflowed grows the buffers to fit it, and they shrink again once a
+// whole window of frames used less than a quarter of them.
+//
+//     ./demo --batch-quads 4096     fixed size, no adapting
+//     ./demo --no-quad-batch        rlgl's batch
+//
+// Needs desktop GL 3.3, as the instanced sprites; otherwise, or with QUAD_BATCH_NO_GL defined, the queue
+// draws through rlgl.
+
+#if defined(__linux__) && !defined(QUAD_BATCH_NO_GL)
+	#define QUAD_BATCH_GL
+	#define GL_GLEXT_PROTOTYPES
+	#include <GL/gl.h>
+	#include <GL/glext.h>
+#endif
+
+#define QUAD_BATCH_BUFFERS 3
+#define QUAD_BATCH_DRAWS 256            // texture or blend runs per flush, as rlgl's DEFAULT_BATCH_DRAWCALLS
+#define QUAD_BATCH_MIN 1024             // quads per buffer
+#define QUAD_BATCH_MAX 65536
+#define QUAD_BATCH_WINDOW 300           // frames under a quarter of the buffer before shrinking
+
+typedef enum { QUAD_FLUSH_OVERFLOW = 0, QUAD_FLUSH_DRAWS, QUAD_FLUSH_SUBMIT, QUAD_FLUSH_CAUSES } QuadFlushCause;
+
+typedef struct QuadBatchConfig {
+	bool enabled;
+	int quads;                      // fixed size, 0 adapts
+} QuadBatchConfig;
+
+typedef struct QuadVertex {
+	float x, y;
+	float u, v;
+	Color color;
+} QuadVertex;
+
+typedef struct QuadDraw {
+	unsigned int texture;
+	int blend;
+	int first;                      // quads
+	int count;
+} QuadDraw;
+
+typedef struct QuadBatchStats {
+	int quads;
+	int drawCalls;
+	int flushes[QUAD_FLUSH_CAUSES];
+	int largestRun;                 // quads between flushes other than overflows
+} QuadBatchStats;
+
+typedef struct QuadBatch {
+	bool active;                    // GL 3.3 batch in use
+	bool adaptive;
+	int capacity;                   // quads per buffer
+	int allocated;                  // quads in 'vertices', never shrinks
+	QuadVertex *vertices;
+	int count;
+	QuadDraw draws[QUAD_BATCH_DRAWS];
+	int drawCount;
+	int run;                        // quads flushed by overflows since the last other flush
+	int current;                    // buffer the next flush fills
+	int quiet;                      // frames in a row under a quarter of the buffer
+	int quietPeak;                  // largest run in those frames
+	int resizes;
+	Shader shader;
+	int projectionLoc;
+	int modelviewLoc;
+	unsigned int vao[QUAD_BATCH_BUFFERS];
+	unsigned int vbo[QUAD_BATCH_BUFFERS];
+	unsigned int ebo;
+	QuadBatchStats stats;           // this frame
+	QuadBatchStats last;            // last frame, for the overlay
+} QuadBatch;
+
+static const char *quadFlushNames[QUAD_FLUSH_CAUSES] = { "overflow", "draw list", "submit" };
+
+static QuadBatchConfig ParseQuadBatchArgs(int argc, char **argv) {
+	QuadBatchConfig config = { true, 0 };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--no-quad-batch") == 0) {
+			config.enabled = false;
+		} else if (strcmp(argv[i], "--batch-quads") == 0 && i + 1 < argc) {
+			config.quads = atoi(argv[++i]);
+			if (config.quads < 0) config.quads = 0;
+			if (config.quads > 0 && config.quads < 64) config.quads = 64;
+			if (config.quads > QUAD_BATCH_MAX) config.quads = QUAD_BATCH_MAX;
+		}
+	}
+	return config;
+}
+
+// Fits 'quads' with a quarter to spare, in powers of two
+static int QuadBatchSize(int quads) {
+	int size = QUAD_BATCH_MIN;
+	while (size < quads + quads/4 && size < QUAD_BATCH_MAX) size *= 2;
+	return size;
+}
+
+#if defined(QUAD_BATCH_GL)
+static const char *quadBatchVertexShader =
+	"#version 330\n"
+	"layout(location = 0) in vec2 vertexPosition;\n"
+	"layout(location = 1) in vec2 vertexTexCoord;\n"
+	"layout(location = 3) in vec4 vertexColor;\n"
+	"uniform mat4 projection;\n"
+	"uniform mat4 modelview;\n"
+	"out vec2 fragTexCoord;\n"
+	"out vec4 fragColor;\n"
+	"void main() {\n"
+	"    fragTexCoord = vertexTexCoord;\n"
+	"    fragColor = vertexColor;\n"
+	"    gl_Position = projection*modelview*vec4(vertexPosition, 0.0, 1.0);\n"
+	"}\n";
+
+static const char *quadBatchFragmentShader =
+	"#version 330\n"
+	"in vec2 fragTexCoord;\n"
+	"in vec4 fragColor;\n"
+	"uniform sampler2D texture0;\n"
+	"out vec4 finalColor;\n"
+	"void main() {\n"
+	"    finalColor = texture(texture0, fragTexCoord)*fragColor;\n"
+	"}\n";
+#endif
+
+// Sizes the vertex buffers, the index buffer is built once for QUAD_BATCH_MAX quads
+static void ResizeQuadBatch(QuadBatch *batch, int capacity) {
+	if (capacity > batch->allocated) {
+		QuadVertex *vertices = (QuadVertex *)realloc(batch->vertices, (size_t)capacity*4*sizeof(QuadVertex));
+		if (vertices == NULL) return;
+		batch->vertices = vertices;
+		batch->allocated = capacity;
+	}
+	batch->capacity = capacity;
+
+#if defined(QUAD_BATCH_GL)
+	for (int b = 0; b < QUAD_BATCH_BUFFERS; b++) {
+		glBindBuffer(GL_ARRAY_BUFFER, batch->vbo[b]);
+		glBufferData(GL_ARRAY_BUFFER, (size_t)capacity*4*sizeof(QuadVertex), NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+static void UnloadQuadBatch(QuadBatch *batch) {
+#if defined(QUAD_BATCH_GL)
+	if (batch->ebo > 0) {
+		glDeleteVertexArrays(QUAD_BATCH_BUFFERS, batch->vao);
+		glDeleteBuffers(QUAD_BATCH_BUFFERS, batch->vbo);
+		glDeleteBuffers(1, &batch->ebo);
+		batch->ebo = 0;
+	}
+	if (batch->shader.id > 0 && batch->shader.id != GetShaderDefault().id) UnloadShader(batch->shader);
+	batch->shader.id = 0;
+#endif
+	free(batch->vertices);
+	batch->vertices = NULL;
+	batch->active = false;
+}
+
+// Call after InitWindow()
+static QuadBatch LoadQuadBatch(QuadBatchConfig config) {
+	QuadBatch batch = { 0 };
+
+#if defined(QUAD_BATCH_GL)
+	int major = 0, minor = 0;
+	const char *version = (const char *)glGetString(GL_VERSION);
+	if (version != NULL) sscanf(version, "%d.%d", &major, &minor);
+
+	if (config.enabled && ((major > 3) || (major == 3 && minor >= 3))) {
+		batch.shader = LoadShaderCode(quadBatchVertexShader, quadBatchFragmentShader);
+		if (batch.shader.id > 0 && batch.shader.id != GetShaderDefault().id) {
+			batch.projectionLoc = GetShaderLocation(batch.shader, "projection");
+			batch.modelviewLoc = GetShaderLocation(batch.shader, "modelview");
+
+			// Two triangles per quad, in rlgl's corner order, shared by every buffer
+			unsigned int *indices = (unsigned int *)malloc((size_t)QUAD_BATCH_MAX*6*sizeof(unsigned int));
+			if (indices == NULL) {
+				TraceLog(LOG_WARNING, "QUADBATCH: could not allocate the index buffer");
+			} else {
+				for (unsigned int q = 0; q < QUAD_BATCH_MAX; q++) {
+					unsigned int *i = indices + 6*q;
+					i[0] = 4*q; i[1] = 4*q + 1; i[2] = 4*q + 2;
+					i[3] = 4*q; i[4] = 4*q + 2; i[5] = 4*q + 3;
+				}
+
+				glGenBuffers(1, &batch.ebo);
+				glGenBuffers(QUAD_BATCH_BUFFERS, batch.vbo);
+				glGenVertexArrays(QUAD_BATCH_BUFFERS, batch.vao);
+
+				for (int b = 0; b < QUAD_BATCH_BUFFERS; b++) {
+					glBindVertexArray(batch.vao[b]);
+					glBindBuffer(GL_ARRAY_BUFFER, batch.vbo[b]);
+					glEnableVertexAttribArray(0);
+					glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void *)offsetof(QuadVertex, x));
+					glEnableVertexAttribArray(1);
+					glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void *)offsetof(QuadVertex, u));
+					glEnableVertexAttribArray(3);
+					glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadVertex), (void *)offsetof(QuadVertex, color));
+					glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.ebo);
+					if (b == 0) glBufferData(GL_ELEMENT_ARRAY_BUFFER, (size_t)QUAD_BATCH_MAX*6*sizeof(unsigned int), indices, GL_STATIC_DRAW);
+				}
+				glBindVertexArray(0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				free(indices);
+
+				batch.adaptive = (config.quads == 0);
+				ResizeQuadBatch(&batch, batch.adaptive ? QUAD_BATCH_MIN : config.quads);
+				batch.active = (batch.vertices != NULL);
+				if (!batch.active) TraceLog(LOG_WARNING, "QUADBATCH: could not allocate the vertices");
+			}
+		}
+		if (!batch.active) UnloadQuadBatch(&batch);     // what was created before the failure
+	}
+#endif
+
+	if (batch.active) TraceLog(LOG_INFO, "QUADBATCH: %i buffers of %i quads (%s)", QUAD_BATCH_BUFFERS, batch.capacity, batch.adaptive ? "adaptive" : "fixed");
+	else TraceLog(LOG_INFO, "QUADBATCH: rlgl's batch");
+	return batch;
+}
+
+#if defined(QUAD_BATCH_GL)
+static void SetQuadBatchBlend(int blend) {
+	switch (blend) {
+		case BLEND_ADDITIVE: glBlendFunc(GL_SRC_ALPHA, GL_ONE); break;
+		case BLEND_MULTIPLIED: glBlendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA); break;
+		default: glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+	}
+}
+#endif
+
+// Draws the quads pushed so far from the next buffer of the ring
+static void FlushQuadBatch(QuadBatch *batch, QuadFlushCause cause) {
+	if (batch->count == 0) return;
+
+#if defined(QUAD_BATCH_GL)
+	rlglDraw();     // flush what rlgl batched so far, keeps the layering
+
+	glBindBuffer(GL_ARRAY_BUFFER, batch->vbo[batch->current]);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (size_t)batch->count*4*sizeof(QuadVertex), batch->vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glUseProgram(batch->shader.id);
+	SetShaderValueMatrix(batch->shader, batch->projectionLoc, GetMatrixProjection());
+	SetShaderValueMatrix(batch->shader, batch->modelviewLoc, GetMatrixModelview());
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(batch->vao[batch->current]);
+
+	int blend = BLEND_ALPHA;
+	for (int d = 0; d < batch->drawCount; d++) {
+		const QuadDraw *draw = &batch->draws[d];
+		if (draw->blend != blend) { SetQuadBatchBlend(draw->blend); blend = draw->blend; }
+		glBindTexture(GL_TEXTURE_2D, draw->texture);
+		glDrawElements(GL_TRIANGLES, draw->count*6, GL_UNSIGNED_INT, (void *)((size_t)draw->first*6*sizeof(unsigned int)));
+	}
+	if (blend != BLEND_ALPHA) SetQuadBatchBlend(BLEND_ALPHA);
+
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glUseProgram(0);
+#endif
+
+	batch->stats.flushes[cause]++;
+	batch->stats.drawCalls += batch->drawCount;
+	if (cause == QUAD_FLUSH_OVERFLOW) {
+		batch->run += batch->count;
+	} else {
+		if (batch->run + batch->count > batch->stats.largestRun) batch->stats.largestRun = batch->run + batch->count;
+		batch->run = 0;
+	}
+	batch->current = (batch->current + 1) % QUAD_BATCH_BUFFERS;
+	batch->count = 0;
+	batch->drawCount = 0;
+}
+
+static void PushQuadBatch(QuadBatch *batch, const Quad *q, int blend) {
+	unsigned int texture = (q->kind == QUAD_RECTANGLE) ? GetTextureDefault().id : q->texture.id;
+	if (texture == 0) return;       // as DrawTexturePro()
+
+	if (batch->count == batch->capacity) FlushQuadBatch(batch, QUAD_FLUSH_OVERFLOW);
+	QuadDraw *draw = (batch->drawCount > 0) ? &batch->draws[batch->drawCount - 1] : NULL;
+	if (draw == NULL || draw->texture != texture || draw->blend != blend) {
+		if (batch->drawCount == QUAD_BATCH_DRAWS) FlushQuadBatch(batch, QUAD_FLUSH_DRAWS);
+		draw = &batch->draws[batch->drawCount++];
+		*draw = (QuadDraw) { texture, blend, batch->count, 0 };
+	}
+
+	QuadVertex *v = batch->vertices + (size_t)batch->count*4;
+	if (q->kind == QUAD_RECTANGLE) {
+		// DrawRectangle() takes integers
+		float x0 = (int)q->dest.x, y0 = (int)q->dest.y, x1 = x0 + (int)q->dest.width, y1 = y0 + (int)q->dest.height;
+		v[0] = (QuadVertex) { x0, y0, 0, 0, q->tint };
+		v[1] = (QuadVertex) { x0, y1, 0, 1, q->tint };
+		v[2] = (QuadVertex) { x1, y1, 1, 1, q->tint };
+		v[3] = (QuadVertex) { x1, y0, 1, 0, q->tint };
+	} else {
+		// DrawTexturePro() with its origin at the corner is the unskewed case
+		SkewQuad s = ComputeSkewQuad(q->texture, q->source, q->dest, (q->kind == QUAD_SKEW) ? q->skew : (Vector2) { 0, 0 }, q->rotation);
+		for (int i = 0; i < 4; i++) v[i] = (QuadVertex) { s.position[i].x, s.position[i].y, s.texcoord[i].x, s.texcoord[i].y, q->tint };
+	}
+	batch->count++;
+	batch->stats.quads++;
+	draw->count++;
+}
+
+// Call once per frame after the last submit (which flushed): keeps the frame's counts and sizes the buffers
+// for the next
+static void EndQuadBatchFrame(QuadBatch *batch) {
+	if (!batch->active) return;
+
+	batch->last = batch->stats;
+	int run = batch->stats.largestRun;
+	batch->stats = (QuadBatchStats) { 0 };
+	if (!batch->adaptive) return;
+
+	if (batch->last.flushes[QUAD_FLUSH_OVERFLOW] > 0 && batch->capacity < QUAD_BATCH_MAX) {
+		ResizeQuadBatch(batch, QuadBatchSize(run));
+		batch->resizes++;
+		batch->quiet = 0;
+	} else if (4*run < batch->capacity && batch->capacity > QUAD_BATCH_MIN) {
+		if (run > batch->quietPeak) batch->quietPeak = run;
+		if (++batch->quiet >= QUAD_BATCH_WINDOW) {
+			ResizeQuadBatch(batch, QuadBatchSize(batch->quietPeak));
+			batch->resizes++;
+			batch->quiet = batch->quietPeak = 0;
+		}
+	} else {
+		batch->quiet = batch->quietPeak = 0;
+	}
+}
+
+// One line for the overlay, the last frame
+static const char *QuadBatchText(const QuadBatch *batch) {
+	static char text[256];
+	if (!batch->active) return "quad batch off, rlgl's batch";
+
+	const QuadBatchStats *s = &batch->last;
+	int length = snprintf(text, sizeof(text), "quad batch %ix%i quads %s, %i resizes: %i quads, largest run %i, %i draw calls, flushes:",
+		QUAD_BATCH_BUFFERS, batch->capacity, batch->adaptive ? "adaptive" : "fixed", batch->resizes, s->quads, s->largestRun, s->drawCalls);
+	for (int c = 0; c < QUAD_FLUSH_CAUSES && length < (int)sizeof(text); c++) {
+		length += snprintf(text + length, sizeof(text) - length, " %s %i", quadFlushNames[c], s->flushes[c]);
+	}
+	return text;
+}
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef __RENDERQUEUE_H__
+#define __RENDERQUEUE_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <math.h>
+#include <stdlib.h>
+#include "rlgl.h"
+#include "arena.h"
+#include "effects.h"
+#include "quadbatch.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Render queue
+// Quads are queued with a layer and a blend mode instead of being drawn, then submitted sorted on
+// (layer, texture, blend): layers stay in order, and inside a layer a quad moves back to the last batch with
+// its texture and blend as long as it crosses no batch it overlaps on screen. Quads that do not overlap can be
+// drawn in any order, so the picture is the same as drawing in submission order, with far fewer texture
+// switches. Every texture switch is a draw call in rlgl, and it flushes every DEFAULT_BATCH_DRAWCALLS of them.
+// With an active quad batch the queue draws through it instead, and the batch counts its real flushes.
+
+#ifndef DEFAULT_BATCH_DRAWCALLS
+	#define DEFAULT_BATCH_DRAWCALLS 256
+#endif
+#ifndef DEFAULT_BATCH_BUFFER_ELEMENTS
+	#define DEFAULT_BATCH_BUFFER_ELEMENTS 8192
+#endif
+
+#define RENDER_QUEUE_WINDOW 64          // batches looked back at to find one to join
+
+typedef enum {
+	RENDER_LAYER_BACKGROUND = 0,
+	RENDER_LAYER_COPPER,
+	RENDER_LAYER_LOGO,
+	RENDER_LAYER_FLAG,
+	RENDER_LAYER_COPPER_BAR,
+	RENDER_LAYER_SCROLLER,
+	RENDER_LAYER_SCROLLER2,
+} RenderLayer;
+
+typedef struct RenderCommand {
+	unsigned long long order;       // layer, then submission order
+	unsigned int texture;           // 0 for rectangles (shapes texture)
+	int blend;
+	Rectangle bounds;               // screen space bounding box
+	Quad quad;
+} RenderCommand;
+
+typedef struct RenderBatch {
+	unsigned int texture;
+	int blend;
+	int layer;
+	Rectangle bounds;
+	int first;
+	int last;
+} RenderBatch;
+
+typedef struct RenderQueue {
+	RenderCommand *commands;
+	int count;
+	int capacity;
+	unsigned int sequence;
+	bool sorted;                    // false submits in queue order, to compare
+	QuadBatch *batch;               // NULL draws through rlgl
+} RenderQueue;
+
+typedef struct RenderQueueStats {
+	int commands;
+	int drawCallsBefore;            // texture or blend switches in submission order
+	int drawCallsAfter;
+	int flushesBefore;              // rlgl batch flushes these draws force
+	int flushesAfter;
+} RenderQueueStats;
+
+static RenderQueueStats renderQueueStats = { 0 };
+
+static RenderQueue BeginRenderQueue(FrameArena *arena, int capacity, bool sorted, QuadBatch *batch) {
+	return (RenderQueue) { FRAME_ALLOC(arena, RenderCommand, capacity), 0, capacity, 0, sorted, (batch != NULL && batch->active) ? batch : NULL };
+}
+
+static bool RenderBoundsOverlap(Rectangle a, Rectangle b) {
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static Rectangle RenderBoundsUnion(Rectangle a, Rectangle b) {
+	float x0 = fminf(a.x, b.x), y0 = fminf(a.y, b.y);
+	float x1 = fmaxf(a.x + a.width, b.x + b.width), y1 = fmaxf(a.y + a.height, b.y + b.height);
+	return (Rectangle) { x0, y0, x1 - x0, y1 - y0 };
+}
+
+static void QueueQuads(RenderQueue *queue, RenderLayer layer, int blend, const QuadList *list) {
+	for (int i = 0; i < list->count && queue->count < queue->capacity; i++) {
+		const Quad *q = &list->quads[i];
+		RenderCommand *c = &queue->commands[queue->count++];
+		c->order = (unsigned long long)layer << 32 | queue->sequence++;
+		c->texture = (q->kind == QUAD_RECTANGLE) ? 0 : q->texture.id;
+		c->blend = blend;
+		c->bounds = QuadBounds(q);
+		c->quad = *q;
+	}
+}
+
+static int CompareRenderCommands(const void *a, const void *b) {
+	unsigned long long oa = ((const RenderCommand *)a)->order, ob = ((const RenderCommand *)b)->order;
+	return (oa > ob) - (oa < ob);
+}
+
+static int RenderFlushes(int drawCalls, int quads) {
+	if (quads == 0) return 0;
+	return 1 + (drawCalls - 1)/DEFAULT_BATCH_DRAWCALLS + (quads - 1)/DEFAULT_BATCH_BUFFER_ELEMENTS;
+}
+
+static void DrawRenderCommand(const RenderCommand *c) {
+	QuadList one = { (Quad *)&c->quad, 1, 1 };
+	DrawQuads(&one);
+}
+
+// Draws everything queued so far and empties the queue, call before anything drawn outside of it
+static void SubmitRenderQueue(RenderQueue *queue, FrameArena *arena) {
+	int n = queue->count;
+	if (n == 0) return;
+
+	qsort(queue->commands, n, sizeof(RenderCommand), CompareRenderCommands);
+
+	int before = 0;
+	for (int i = 0; i < n; i++) {
+		const RenderCommand *c = &queue->commands[i];
+		if (i == 0 || c->texture != c[-1].texture || c->blend != c[-1].blend) before++;
+	}
+
+	int after = 0;
+	int blend = BLEND_ALPHA;
+
+	if (!queue->sorted) {
+		for (int i = 0; i < n; i++) {
+			const RenderCommand *c = &queue->commands[i];
+			if (queue->batch != NULL) { PushQuadBatch(queue->batch, &c->quad, c->blend); continue; }
+			if (c->blend != blend) { EndBlendMode(); if (c->blend != BLEND_ALPHA) BeginBlendMode(c->blend); blend = c->blend; }
+			DrawRenderCommand(c);
+		}
+		after = before;
+	} else {
+		RenderBatch *batches = FRAME_ALLOC(arena, RenderBatch, n);
+		int *next = FRAME_ALLOC(arena, int, n);
+		int batchCount = 0, layerStart = 0, layer = -1;
+
+		for (int i = 0; i < n; i++) {
+			const RenderCommand *c = &queue->commands[i];
+			int commandLayer = (int)(c->order >> 32);
+			if (commandLayer != layer) { layer = commandLayer; layerStart = batchCount; }
+
+			// Latest batch to join, unless a batch drawn after it overlaps this quad
+			int target = -1;
+			int limit = (batchCount - RENDER_QUEUE_WINDOW > layerStart) ? batchCount - RENDER_QUEUE_WINDOW : layerStart;
+			for (int b = batchCount - 1; b >= limit; b--) {
+				if (batches[b].texture == c->texture && batches[b].blend == c->blend) { target = b; break; }
+				if (RenderBoundsOverlap(batches[b].bounds, c->bounds)) break;
+			}
+
+			next[i] = -1;
+			if (target < 0) {
+				batches[batchCount++] = (RenderBatch) { c->texture, c->blend, layer, c->bounds, i, i };
+			} else {
+				RenderBatch *batch = &batches[target];
+				next[batch->last] = i;
+				batch->last = i;
+				batch->bounds = RenderBoundsUnion(batch->bounds, c->bounds);
+			}
+		}
+
+		for (int b = 0; b < batchCount; b++) {
+			if (b == 0 || batches[b].texture != batches[b - 1].texture || batches[b].blend != batches[b - 1].blend) after++;
+			if (queue->batch != NULL) {
+				for (int i = batches[b].first; i >= 0; i = next[i]) PushQuadBatch(queue->batch, &queue->commands[i].quad, batches[b].blend);
+				continue;
+			}
+			if (batches[b].blend != blend) { EndBlendMode(); if (batches[b].blend != BLEND_ALPHA) BeginBlendMode(batches[b].blend); blend = batches[b].blend; }
+			for (int i = batches[b].first; i >= 0; i = next[i]) DrawRenderCommand(&queue->commands[i]);
+		}
+	}
+	if (blend != BLEND_ALPHA) EndBlendMode();
+	if (queue->batch != NULL) FlushQuadBatch(queue->batch, QUAD_FLUSH_SUBMIT);
+
+	renderQueueStats.commands += n;
+	renderQueueStats.drawCallsBefore += before;
+	renderQueueStats.drawCallsAfter += after;
+	renderQueueStats.flushesBefore += RenderFlushes(before, n);
+	renderQueueStats.flushesAfter += RenderFlushes(after, n);
+	queue->count = 0;
+}
+
+static void ResetRenderQueueStats(void) {
+	renderQueueStats = (RenderQueueStats) { 0 };
+}
+
+#endif
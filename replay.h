@@ -0,0 +1,193 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Record and replay
+// Everything that makes two runs differ goes through one FrameInput per frame: the frame time, the seed of
+// rand() (GetRandomValue draws from it) and the keys the demo reads. Recording writes them to a small binary
+// file, replay reads them back instead of polling, so two builds run the same frames:
+//
+//     ./demo --record run.rpl
+//     ./demo --replay run.rpl [--benchmark 100000]
+//
+// Replay with the same options as the recording. The file is a header (magic, version, seed used before the
+// effects are set up) then one record per frame: a flags byte, the frame time when it changed, the rand() seed
+// of the frame, and the keys when they changed; about 5 bytes a frame at a steady frame rate.
+
+#define REPLAY_MAGIC "DRPL"
+#define REPLAY_VERSION 1
+
+typedef enum {
+	INPUT_OVERLAY = 1 << 0,         // keypad Enter, held
+	INPUT_FOUR = 1 << 1,            // 4, 0 and 1 held together quit
+	INPUT_ZERO = 1 << 2,
+	INPUT_ONE = 1 << 3,
+	INPUT_F1 = 1 << 4,              // function keys, pressed this frame
+	INPUT_F2 = 1 << 5,
+	INPUT_F3 = 1 << 6,
+	INPUT_F4 = 1 << 7,
+	INPUT_F5 = 1 << 8,
+	INPUT_F6 = 1 << 9,
+	INPUT_EXIT = INPUT_FOUR | INPUT_ZERO | INPUT_ONE,
+} InputKey;
+
+enum { REPLAY_SAME_DT = 1 << 0, REPLAY_SAME_KEYS = 1 << 1 };
+
+typedef struct FrameInput {
+	float dt;
+	unsigned int seed;
+	unsigned short keys;
+} FrameInput;
+
+typedef struct ReplayConfig {
+	const char *record;
+	const char *replay;
+} ReplayConfig;
+
+typedef struct Replay {
+	FILE *file;
+	bool recording;
+	int frames;
+	FrameInput last;                // previous record, for the flags
+} Replay;
+
+static ReplayConfig ParseReplayArgs(int argc, char **argv) {
+	ReplayConfig config = { NULL, NULL };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) config.record = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) config.replay = argv[++i];
+	}
+	return config;
+}
+
+static void WriteReplayU32(FILE *file, unsigned int value) {
+	unsigned char bytes[4] = { value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, value >> 24 };
+	fwrite(bytes, 1, 4, file);
+}
+
+static bool ReadReplayU32(FILE *file, unsigned int *value) {
+	unsigned char bytes[4];
+	if (fread(bytes, 1, 4, file) != 4) return false;
+	*value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (unsigned int)bytes[3] << 24;
+	return true;
+}
+
+// Call after InitWindow and before anything draws random numbers: seeds rand() with 'seed' when recording, with
+// the recorded seed when replaying. NULL when neither was asked for, or when the file could not be opened.
+static Replay *OpenReplay(ReplayConfig config, unsigned int seed) {
+	const char *path = config.replay != NULL ? config.replay : config.record;
+	if (path == NULL) return NULL;
+
+	bool recording = config.replay == NULL;
+	FILE *file = fopen(path, recording ? "wb" : "rb");
+	if (file == NULL) {
+		TraceLog(LOG_WARNING, "REPLAY: could not open %s", path);
+		return NULL;
+	}
+
+	if (recording) {
+		fwrite(REPLAY_MAGIC, 1, 4, file);
+		WriteReplayU32(file, REPLAY_VERSION);
+		WriteReplayU32(file, seed);
+	} else {
+		char magic[4];
+		unsigned int version = 0;
+		if (fread(magic, 1, 4, file) != 4 || memcmp(magic, REPLAY_MAGIC, 4) != 0 || !ReadReplayU32(file, &version) ||
+			version != REPLAY_VERSION || !ReadReplayU32(file, &seed)) {
+			TraceLog(LOG_WARNING, "REPLAY: %s is not a replay file", path);
+			fclose(file);
+			return NULL;
+		}
+	}
+	srand(seed);
+
+	Replay *replay = (Replay *)calloc(1, sizeof(Replay));
+	replay->file = file;
+	replay->recording = recording;
+	TraceLog(LOG_INFO, "REPLAY: %s %s", recording ? "recording to" : "replaying", path);
+	return replay;
+}
+
+static unsigned short PollInputKeys(void) {
+	unsigned short keys = 0;
+	if (IsKeyDown(KEY_KP_ENTER)) keys |= INPUT_OVERLAY;
+	if (IsKeyDown(KEY_FOUR)) keys |= INPUT_FOUR;
+	if (IsKeyDown(KEY_ZERO)) keys |= INPUT_ZERO;
+	if (IsKeyDown(KEY_ONE)) keys |= INPUT_ONE;
+	if (IsKeyPressed(KEY_F1)) keys |= INPUT_F1;
+	if (IsKeyPressed(KEY_F2)) keys |= INPUT_F2;
+	if (IsKeyPressed(KEY_F3)) keys |= INPUT_F3;
+	if (IsKeyPressed(KEY_F4)) keys |= INPUT_F4;
+	if (IsKeyPressed(KEY_F5)) keys |= INPUT_F5;
+	if (IsKeyPressed(KEY_F6)) keys |= INPUT_F6;
+	return keys;
+}
+
+static void WriteFrameInput(Replay *replay, const FrameInput *input) {
+	unsigned char flags = 0;
+	if (replay->frames > 0 && input->dt == replay->last.dt) flags |= REPLAY_SAME_DT;
+	if (replay->frames > 0 && input->keys == replay->last.keys) flags |= REPLAY_SAME_KEYS;
+
+	fputc(flags, replay->file);
+	if (!(flags & REPLAY_SAME_DT)) {
+		unsigned int bits;
+		memcpy(&bits, &input->dt, sizeof(bits));
+		WriteReplayU32(replay->file, bits);
+	}
+	WriteReplayU32(replay->file, input->seed);
+	if (!(flags & REPLAY_SAME_KEYS)) { fputc(input->keys & 0xff, replay->file); fputc(input->keys >> 8, replay->file); }
+}
+
+static bool ReadFrameInput(Replay *replay, FrameInput *input) {
+	int flags = fgetc(replay->file);
+	if (flags == EOF) return false;
+
+	*input = replay->last;
+	if (!(flags & REPLAY_SAME_DT)) {
+		unsigned int bits;
+		if (!ReadReplayU32(replay->file, &bits)) return false;
+		memcpy(&input->dt, &bits, sizeof(bits));
+	}
+	if (!ReadReplayU32(replay->file, &input->seed)) return false;
+	if (!(flags & REPLAY_SAME_KEYS)) {
+		int low = fgetc(replay->file), high = fgetc(replay->file);
+		if (high == EOF) return false;
+		input->keys = (unsigned short)(low | high << 8);
+	}
+	return true;
+}
+
+// Input of the next frame, 'dt' being the live frame time; returns false when the replay has no frames left
+static bool NextFrameInput(Replay *replay, float dt, FrameInput *input) {
+	if (replay == NULL) {
+		*input = (FrameInput) { dt, 0, PollInputKeys() };
+		return true;
+	}
+
+	if (replay->recording) {
+		*input = (FrameInput) { dt, (unsigned int)rand(), PollInputKeys() };
+		WriteFrameInput(replay, input);
+	} else if (!ReadFrameInput(replay, input)) {
+		return false;
+	}
+	replay->last = *input;
+	replay->frames++;
+	srand(input->seed);
+	return true;
+}
+
+static void CloseReplay(Replay *replay) {
+	TraceLog(LOG_INFO, "REPLAY: %i frames %s", replay->frames, replay->recording ? "recorded" : "replayed");
+	fclose(replay->file);
+	free(replay);
+}
+
+#endif
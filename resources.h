@@ -0,0 +1,137 @@
+#ifndef __RESOURCES_H__
+#define __RESOURCES_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stddef.h>
+#include <pthread.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Resource registry
+// Every texture, render texture and music stream is loaded through these wrappers so their memory can be
+// accounted for. ReportResources() lists what was never released, call it just before CloseWindow(). The
+// registry is locked, the music is loaded on a startup thread while the textures load.
+
+#define MAX_RESOURCES 128
+#define RESOURCE_STREAM_FRAMES 4096     // raylib default audio stream buffer size, double buffered
+
+typedef enum { RESOURCE_TEXTURE = 0, RESOURCE_RENDER_TEXTURE, RESOURCE_MUSIC, RESOURCE_TYPES } ResourceType;
+
+typedef struct Resource {
+	ResourceType type;
+	const void *handle;         // texture id or music context, used to find the entry again
+	unsigned int id;
+	const char *name;
+	size_t bytes;
+	bool live;
+} Resource;
+
+typedef struct ResourceStats {
+	int count[RESOURCE_TYPES];
+	size_t bytes[RESOURCE_TYPES];
+	size_t total;
+	size_t peak;
+} ResourceStats;
+
+static Resource resources[MAX_RESOURCES];
+static int resourceCount = 0;
+static ResourceStats resourceStats = { 0 };
+
+static const char *resourceTypeNames[RESOURCE_TYPES] = { "texture", "render texture", "music" };
+static pthread_mutex_t resourceLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void TrackResource(ResourceType type, unsigned int id, const void *handle, const char *name, size_t bytes) {
+	pthread_mutex_lock(&resourceLock);
+	int slot = -1;
+	for (int i = 0; i < resourceCount; i++) {
+		if (!resources[i].live) { slot = i; break; }
+	}
+	if (slot < 0) {
+		if (resourceCount == MAX_RESOURCES) {
+			TraceLog(LOG_WARNING, "RESOURCE: registry full, %s not tracked", name);
+			pthread_mutex_unlock(&resourceLock);
+			return;
+		}
+		slot = resourceCount++;
+	}
+
+	resources[slot] = (Resource) { type, handle, id, name, bytes, true };
+	resourceStats.count[type]++;
+	resourceStats.bytes[type] += bytes;
+	resourceStats.total += bytes;
+	if (resourceStats.total > resourceStats.peak) resourceStats.peak = resourceStats.total;
+	pthread_mutex_unlock(&resourceLock);
+}
+
+static void UntrackResource(ResourceType type, unsigned int id, const void *handle) {
+	pthread_mutex_lock(&resourceLock);
+	for (int i = 0; i < resourceCount; i++) {
+		Resource *r = &resources[i];
+		if (r->live && r->type == type && r->id == id && r->handle == handle) {
+			r->live = false;
+			resourceStats.count[type]--;
+			resourceStats.bytes[type] -= r->bytes;
+			resourceStats.total -= r->bytes;
+			pthread_mutex_unlock(&resourceLock);
+			return;
+		}
+	}
+	pthread_mutex_unlock(&resourceLock);
+	TraceLog(LOG_WARNING, "RESOURCE: releasing untracked %s [ID %i]", resourceTypeNames[type], id);
+}
+
+static Texture2D LoadTrackedTexture(Image image, const char *name) {
+	Texture2D texture = LoadTextureFromImage(image);
+	if (texture.id > 0) TrackResource(RESOURCE_TEXTURE, texture.id, NULL, name, GetPixelDataSize(texture.width, texture.height, texture.format));
+	return texture;
+}
+
+static void UnloadTrackedTexture(Texture2D texture) {
+	if (texture.id > 0) UntrackResource(RESOURCE_TEXTURE, texture.id, NULL);
+	UnloadTexture(texture);
+}
+
+// Color attachment plus the 24 bit depth renderbuffer raylib creates with it (stored in 32 bits)
+static RenderTexture2D LoadTrackedRenderTexture(int width, int height, const char *name) {
+	RenderTexture2D target = LoadRenderTexture(width, height);
+	if (target.id > 0) TrackResource(RESOURCE_RENDER_TEXTURE, target.id, NULL, name, (size_t)width*height*4*2);
+	return target;
+}
+
+static void UnloadTrackedRenderTexture(RenderTexture2D target) {
+	if (target.id > 0) UntrackResource(RESOURCE_RENDER_TEXTURE, target.id, NULL);
+	UnloadRenderTexture(target);
+}
+
+// Only the stream buffers are counted, the decoder state lives inside raylib's audio module
+static Music LoadTrackedMusic(const char *fileName) {
+	Music music = LoadMusicStream(fileName);
+	if (music.ctxData != NULL) {
+		size_t bytes = (size_t)RESOURCE_STREAM_FRAMES*2*music.stream.channels*(music.stream.sampleSize/8);
+		TrackResource(RESOURCE_MUSIC, 0, music.ctxData, fileName, bytes);
+	}
+	return music;
+}
+
+static void UnloadTrackedMusic(Music music) {
+	if (music.ctxData != NULL) UntrackResource(RESOURCE_MUSIC, 0, music.ctxData);
+	UnloadMusicStream(music);
+}
+
+// Lists every resource still alive, returns how many there were
+static int ReportResources(void) {
+	int leaks = 0;
+	for (int i = 0; i < resourceCount; i++) {
+		Resource *r = &resources[i];
+		if (!r->live) continue;
+		TraceLog(LOG_WARNING, "RESOURCE: unreleased %s '%s' [ID %i] %i bytes", resourceTypeNames[r->type], r->name, r->id, (int)r->bytes);
+		leaks++;
+	}
+
+	if (leaks > 0) TraceLog(LOG_WARNING, "RESOURCE: %i resources (%i KB) not released, peak was %i KB", leaks, (int)(resourceStats.total/1024), (int)(resourceStats.peak/1024));
+	else TraceLog(LOG_INFO, "RESOURCE: all resources released, peak was %i KB", (int)(resourceStats.peak/1024));
+	return leaks;
+}
+
+#endif
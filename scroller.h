@@ -0,0 +1,176 @@
+#ifndef __SCROLLER_H__
+#define __SCROLLER_H__
+
+#pragma once
+
+#include <raylib.h>
+#include "resources.h"
+#include "bitmapfont.h"
+#include "effects.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Strip scroller
+// The message is rendered once into a ring of wide strip pages, then scrolled by drawing one or two skewed
+// quads with a moving source offset. Pages ahead of the scroll position are filled a few glyphs per frame,
+// so the cost per frame does not depend on the message length.
+
+#define STRIP_PAGE_WIDTH 2048
+#define STRIP_PAGES 3
+#define STRIP_GLYPHS_PER_STEP 16
+
+typedef struct StripPage {
+	RenderTexture2D target;
+	int page;       // page of the message held by this slot, -1 when free
+	int filled;     // glyphs already rendered into it
+} StripPage;
+
+typedef struct StripScroller {
+	const BitmapFont *font;
+	const BitmapText *text;
+	int textLen;
+	int glyphSize;          // fixed advance of the font, pages are one glyph high
+	int glyphsPerPage;
+	int pageCount;
+	StripPage slots[STRIP_PAGES];
+} StripScroller;
+
+static StripScroller LoadStripScroller(const BitmapFont *font, const BitmapText *text) {
+	StripScroller s = { 0 };
+	int glyphSize = font->glyphWidth;
+	s.font = font;
+	s.text = text;
+	s.textLen = text->length;
+	s.glyphSize = glyphSize;
+	s.glyphsPerPage = STRIP_PAGE_WIDTH / glyphSize;
+	s.pageCount = (s.textLen + s.glyphsPerPage - 1) / s.glyphsPerPage;
+
+	for (int i = 0; i < STRIP_PAGES; i++) {
+		s.slots[i].target = LoadTrackedRenderTexture(STRIP_PAGE_WIDTH, font->glyphHeight, "strip page");
+		SetTextureFilter(s.slots[i].target.texture, FILTER_POINT);
+		s.slots[i].page = -1;
+		s.slots[i].filled = 0;
+	}
+	return s;
+}
+
+static void UnloadStripScroller(StripScroller *s) {
+	for (int i = 0; i < STRIP_PAGES; i++) {
+		UnloadTrackedRenderTexture(s->slots[i].target);
+		s->slots[i].page = -1;
+	}
+}
+
+static StripPage *FindStripPage(StripScroller *s, int page) {
+	for (int i = 0; i < STRIP_PAGES; i++) {
+		if (s->slots[i].page == page) return &s->slots[i];
+	}
+	return NULL;
+}
+
+// Render up to 'budget' more glyphs of a page, returns how many were rendered
+static int FillStripPage(StripScroller *s, StripPage *slot, int budget) {
+	int first = slot->page * s->glyphsPerPage;
+	int count = s->glyphsPerPage;
+	if (first + count > s->textLen) count = s->textLen - first;
+
+	int end = slot->filled + budget;
+	if (end > count) end = count;
+	if (slot->filled >= end) return 0;
+
+	BeginTextureMode(slot->target);
+	if (slot->filled == 0) ClearBackground(BLANK);
+	for (int i = slot->filled; i < end; i++) {
+		Rectangle source = GetBitmapGlyphSource(s->font, s->text->glyphs[first + i]);
+		DrawTexturePro(s->font->texture, source,
+			(Rectangle) { i * s->glyphSize, 0, source.width, source.height },
+			(Vector2) {0}, 0, WHITE);
+	}
+	EndTextureMode();
+
+	int rendered = end - slot->filled;
+	slot->filled = end;
+	return rendered;
+}
+
+static bool StripPageComplete(StripScroller *s, StripPage *slot) {
+	int count = s->glyphsPerPage;
+	if ((slot->page + 1) * s->glyphsPerPage > s->textLen) count = s->textLen - slot->page * s->glyphsPerPage;
+	return slot->filled >= count;
+}
+
+// Visible range of the message in strip pixels for a scroll position
+static void StripVisibleRange(StripScroller *s, float scrollX, float screenWidth, int *u0, int *u1) {
+	int total = s->textLen * s->glyphSize;
+	*u0 = (int)(-scrollX) - s->glyphSize;
+	*u1 = (int)(screenWidth - scrollX) + s->glyphSize + 1;
+	if (*u0 < 0) *u0 = 0;
+	if (*u1 > total) *u1 = total;
+}
+
+// Must be called outside of any texture mode: makes the visible pages resident and complete, then spends the
+// per frame budget on the next page so it is ready before it scrolls in (wrapping to the first page).
+static void UpdateStripScroller(StripScroller *s, float scrollX, float screenWidth) {
+	if (s->pageCount == 0) return;
+
+	int u0, u1;
+	StripVisibleRange(s, scrollX, screenWidth, &u0, &u1);
+	int first = (u1 > u0) ? u0 / STRIP_PAGE_WIDTH : 0;
+
+	int wanted[STRIP_PAGES];
+	for (int i = 0; i < STRIP_PAGES; i++) wanted[i] = (first + i) % s->pageCount;
+
+	// Free the slots holding pages that are no longer wanted
+	for (int i = 0; i < STRIP_PAGES; i++) {
+		bool keep = false;
+		for (int j = 0; j < STRIP_PAGES; j++) keep |= (s->slots[i].page == wanted[j]);
+		if (!keep) s->slots[i].page = -1;
+	}
+
+	for (int j = 0; j < STRIP_PAGES; j++) {
+		StripPage *slot = FindStripPage(s, wanted[j]);
+		if (slot == NULL) {
+			slot = FindStripPage(s, -1);
+			slot->page = wanted[j];
+			slot->filled = 0;
+		}
+
+		if (j < 2 && (j * STRIP_PAGE_WIDTH) < (u1 - first * STRIP_PAGE_WIDTH)) {
+			FillStripPage(s, slot, s->glyphsPerPage);
+		} else if (!StripPageComplete(s, slot)) {
+			FillStripPage(s, slot, STRIP_GLYPHS_PER_STEP);
+			break;
+		}
+	}
+}
+
+// The visible part of the message, one quad per page it crosses (two at most)
+static void EmitStripScroller(QuadList *out, StripScroller *s, float scrollX, float y, float height, float screenWidth, Vector2 skew, Color tint) {
+	int u0, u1;
+	StripVisibleRange(s, scrollX, screenWidth, &u0, &u1);
+
+	while (u0 < u1) {
+		int page = u0 / STRIP_PAGE_WIDTH;
+		int pageEnd = (page + 1) * STRIP_PAGE_WIDTH;
+		int end = (u1 < pageEnd) ? u1 : pageEnd;
+		StripPage *slot = FindStripPage(s, page);
+
+		if (slot != NULL) {
+			float srcX = u0 - page * STRIP_PAGE_WIDTH;
+			float width = end - u0;
+			PushSkewQuad(out, slot->target.texture,
+				(Rectangle) { srcX, 0, width, -s->font->glyphHeight },
+				(Rectangle) { scrollX + u0, y, width, height },
+				skew, tint);
+		}
+		u0 = end;
+	}
+}
+
+static void DrawStripScroller(StripScroller *s, float scrollX, float y, float height, float screenWidth, Vector2 skew, Color tint) {
+	Quad quads[STRIP_PAGES];
+	QuadList list = { quads, 0, STRIP_PAGES };
+	EmitStripScroller(&list, s, scrollX, y, height, screenWidth, skew, tint);
+	DrawQuads(&list);
+}
+
+#endif
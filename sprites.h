@@ -0,0 +1,261 @@
+#ifndef __SPRITES_H__
+#define __SPRITES_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "rlgl.h"
+
+// -------------------------------------------------------------------------------------------------------------
+// Instanced sprites
+// One instance buffer per sprite texture, holding position and tint. Each range of instances is drawn with a
+// single glDrawArraysInstanced call from a GL 3.3 shader, so the number of draw calls does not depend on the
+// number of sprites. Needs desktop GL 3.3 (Mesa llvmpipe is fine); otherwise, or with SPRITES_NO_INSTANCING
+// defined, ranges are drawn with one DrawTexture per sprite.
+
+#if defined(__linux__) && !defined(SPRITES_NO_INSTANCING)
+	#define SPRITES_INSTANCING
+	#define GL_GLEXT_PROTOTYPES
+	#include <GL/gl.h>
+	#include <GL/glext.h>
+#endif
+
+typedef struct SpriteInstance {
+	float x;
+	float y;
+	Color tint;
+} SpriteInstance;
+
+typedef struct SpriteBatch {
+	Texture2D texture;
+	SpriteInstance *instances;
+	int count;
+	int capacity;
+	unsigned int vao;
+	unsigned int instanceBuffer;
+	int bufferCapacity;
+} SpriteBatch;
+
+typedef struct SpriteRange {
+	SpriteBatch *batch;
+	int first;
+	int count;
+} SpriteRange;
+
+typedef struct SpriteRenderer {
+	bool instancing;
+	Shader shader;
+	int projectionLoc;
+	int modelviewLoc;
+	int sizeLoc;
+	unsigned int quadBuffer;
+	int drawCalls;          // sprite draw calls issued this frame
+	int sprites;            // sprites drawn this frame
+} SpriteRenderer;
+
+static SpriteRenderer spriteRenderer = { 0 };
+
+#if defined(SPRITES_INSTANCING)
+static const char *spriteVertexShader =
+	"#version 330\n"
+	"layout(location = 0) in vec2 vertexPosition;\n"
+	"layout(location = 6) in vec2 instancePosition;\n"
+	"layout(location = 7) in vec4 instanceColor;\n"
+	"uniform mat4 projection;\n"
+	"uniform mat4 modelview;\n"
+	"uniform vec2 spriteSize;\n"
+	"out vec2 fragTexCoord;\n"
+	"out vec4 fragColor;\n"
+	"void main() {\n"
+	"    fragTexCoord = vertexPosition;\n"
+	"    fragColor = instanceColor;\n"
+	"    gl_Position = projection*modelview*vec4(instancePosition + vertexPosition*spriteSize, 0.0, 1.0);\n"
+	"}\n";
+
+static const char *spriteFragmentShader =
+	"#version 330\n"
+	"in vec2 fragTexCoord;\n"
+	"in vec4 fragColor;\n"
+	"uniform sampler2D texture0;\n"
+	"out vec4 finalColor;\n"
+	"void main() {\n"
+	"    finalColor = texture(texture0, fragTexCoord)*fragColor;\n"
+	"}\n";
+#endif
+
+// Call after InitWindow(), falls back to DrawTexture when instancing is not available
+static void InitSpriteRenderer(void) {
+	spriteRenderer.instancing = false;
+
+#if defined(SPRITES_INSTANCING)
+	int major = 0, minor = 0;
+	const char *version = (const char *)glGetString(GL_VERSION);
+	if (version != NULL) sscanf(version, "%d.%d", &major, &minor);
+
+	if ((major > 3) || (major == 3 && minor >= 3)) {
+		spriteRenderer.shader = LoadShaderCode(spriteVertexShader, spriteFragmentShader);
+		if (spriteRenderer.shader.id > 0 && spriteRenderer.shader.id != GetShaderDefault().id) {
+			spriteRenderer.projectionLoc = GetShaderLocation(spriteRenderer.shader, "projection");
+			spriteRenderer.modelviewLoc = GetShaderLocation(spriteRenderer.shader, "modelview");
+			spriteRenderer.sizeLoc = GetShaderLocation(spriteRenderer.shader, "spriteSize");
+
+			// Two triangles of a unit quad, shared by every batch
+			static const float quad[12] = { 0,0, 0,1, 1,1, 0,0, 1,1, 1,0 };
+			glGenBuffers(1, &spriteRenderer.quadBuffer);
+			glBindBuffer(GL_ARRAY_BUFFER, spriteRenderer.quadBuffer);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			spriteRenderer.instancing = true;
+		}
+	}
+#endif
+
+	TraceLog(LOG_INFO, "SPRITES: %s", spriteRenderer.instancing ? "instanced rendering (GL 3.3)" : "one draw per sprite");
+}
+
+static void CloseSpriteRenderer(void) {
+#if defined(SPRITES_INSTANCING)
+	if (spriteRenderer.instancing) {
+		glDeleteBuffers(1, &spriteRenderer.quadBuffer);
+		UnloadShader(spriteRenderer.shader);
+	}
+#endif
+	spriteRenderer.instancing = false;
+}
+
+static SpriteBatch LoadSpriteBatch(Texture2D texture, int capacity) {
+	SpriteBatch batch = { 0 };
+	batch.texture = texture;
+	batch.capacity = capacity;
+	batch.instances = (SpriteInstance *)malloc(capacity*sizeof(SpriteInstance));
+	if (batch.instances == NULL) {
+		TraceLog(LOG_WARNING, "SPRITES: could not allocate %i instances, the batch grows as sprites are pushed", capacity);
+		batch.capacity = 0;
+	}
+
+#if defined(SPRITES_INSTANCING)
+	if (spriteRenderer.instancing) {
+		glGenVertexArrays(1, &batch.vao);
+		glBindVertexArray(batch.vao);
+
+		glBindBuffer(GL_ARRAY_BUFFER, spriteRenderer.quadBuffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+		glGenBuffers(1, &batch.instanceBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, batch.instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, capacity*sizeof(SpriteInstance), NULL, GL_DYNAMIC_DRAW);
+		batch.bufferCapacity = capacity;
+		glEnableVertexAttribArray(6);
+		glVertexAttribDivisor(6, 1);
+		glEnableVertexAttribArray(7);
+		glVertexAttribDivisor(7, 1);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+#endif
+	return batch;
+}
+
+static void UnloadSpriteBatch(SpriteBatch *batch) {
+#if defined(SPRITES_INSTANCING)
+	if (batch->vao > 0) {
+		glDeleteBuffers(1, &batch->instanceBuffer);
+		glDeleteVertexArrays(1, &batch->vao);
+	}
+#endif
+	free(batch->instances);
+	batch->instances = NULL;
+	batch->count = batch->capacity = 0;
+}
+
+static void ClearSpriteBatch(SpriteBatch *batch) {
+	batch->count = 0;
+}
+
+static void PushSprite(SpriteBatch *batch, float x, float y, Color tint) {
+	if (batch->count == batch->capacity) {
+		int capacity = batch->capacity*2 + 16;
+		SpriteInstance *instances = (SpriteInstance *)realloc(batch->instances, capacity*sizeof(SpriteInstance));
+		if (instances == NULL) return;
+		batch->instances = instances;
+		batch->capacity = capacity;
+	}
+	batch->instances[batch->count++] = (SpriteInstance) { x, y, tint };
+}
+
+static SpriteRange BeginSpriteRange(SpriteBatch *batch) {
+	return (SpriteRange) { batch, batch->count, 0 };
+}
+
+static void EndSpriteRange(SpriteRange *range) {
+	range->count = range->batch->count - range->first;
+}
+
+// Sends the whole batch to its instance buffer, once per frame after every sprite was pushed
+static void UploadSpriteBatch(SpriteBatch *batch) {
+#if defined(SPRITES_INSTANCING)
+	if (batch->vao == 0 || batch->count == 0) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, batch->instanceBuffer);
+	if (batch->count > batch->bufferCapacity) {
+		glBufferData(GL_ARRAY_BUFFER, batch->capacity*sizeof(SpriteInstance), NULL, GL_DYNAMIC_DRAW);
+		batch->bufferCapacity = batch->capacity;
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, batch->count*sizeof(SpriteInstance), batch->instances);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+static void DrawSpriteRange(SpriteRange range) {
+	SpriteBatch *batch = range.batch;
+	if (range.count <= 0) return;
+
+	spriteRenderer.sprites += range.count;
+
+#if defined(SPRITES_INSTANCING)
+	if (batch->vao > 0) {
+		rlglDraw();     // flush what rlgl batched so far, keeps the layering
+
+		Vector2 size = { batch->texture.width, batch->texture.height };
+
+		glUseProgram(spriteRenderer.shader.id);
+		SetShaderValueMatrix(spriteRenderer.shader, spriteRenderer.projectionLoc, GetMatrixProjection());
+		SetShaderValueMatrix(spriteRenderer.shader, spriteRenderer.modelviewLoc, GetMatrixModelview());
+		SetShaderValue(spriteRenderer.shader, spriteRenderer.sizeLoc, &size, UNIFORM_VEC2);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, batch->texture.id);
+
+		glBindVertexArray(batch->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, batch->instanceBuffer);
+		glVertexAttribPointer(6, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void *)(range.first*sizeof(SpriteInstance)));
+		glVertexAttribPointer(7, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteInstance), (void *)(range.first*sizeof(SpriteInstance) + offsetof(SpriteInstance, tint)));
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, range.count);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glUseProgram(0);
+
+		spriteRenderer.drawCalls++;
+		return;
+	}
+#endif
+
+	for (int i = range.first; i < range.first + range.count; i++) {
+		DrawTexture(batch->texture, batch->instances[i].x, batch->instances[i].y, batch->instances[i].tint);
+	}
+	spriteRenderer.drawCalls += range.count;
+}
+
+static void ResetSpriteStats(void) {
+	spriteRenderer.drawCalls = 0;
+	spriteRenderer.sprites = 0;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef __STARFIELD_H__
+#define __STARFIELD_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <math.h>
+#include <stdlib.h>
+#include "sprites.h"
+
+#define MAXSTARS 8
+
+typedef struct Stars {
+	float x;
+	float y;
+	float speedX;
+	float speedY;
+    float xsin;
+    float ysin;
+} Stars;
+
+typedef struct Starfield2D {
+	Texture2D sprite;
+	Vector2 position;
+	Vector2 size;
+	int count;
+	Stars *stars;
+} Starfield2D;
+
+Starfield2D Init_Starfield2D(Texture2D sprite, Vector2 position, Vector2 size);
+void SetSpeed_Starfield2D(Starfield2D *starfield, Vector2 speed);
+void Resize_Starfield2D(Starfield2D *starfield, int count);
+void Unload_Starfield2D(Starfield2D *starfield);
+void Draw_Starfield2D(Starfield2D *starfield, Vector2 velocity);
+void Update_Starfield2D(Starfield2D *starfield, Vector2 velocity, SpriteBatch *batch);
+
+// -------------------------------------------------------------------------------------------------------------
+Starfield2D Init_Starfield2D(Texture2D sprite, Vector2 position, Vector2 size) {
+	Starfield2D p;
+	p.sprite = sprite;
+	p.position = position;
+	p.size = size;
+	p.count = MAXSTARS;
+	p.stars = (Stars *)calloc(MAXSTARS, sizeof(Stars));
+	if (p.stars == NULL) {
+		TraceLog(LOG_WARNING, "STARFIELD: could not allocate %i stars", MAXSTARS);
+		p.count = 0;
+	}
+	
+	for(int i = 0; i < p.count; i++) {
+		p.stars[i].x = GetRandomValue(p.position.x , p.position.x + p.size.x);
+		p.stars[i].y = GetRandomValue(p.position.y , p.position.y + p.size.y);
+	}
+
+	return p;
+}
+
+void SetSpeed_Starfield2D(Starfield2D *starfield, Vector2 speed) {
+	for(int i = 0; i < starfield->count; i++) {
+		starfield->stars[i].speedX = speed.x;
+		starfield->stars[i].speedY = speed.y;
+		starfield->stars[i].xsin = GetRandomValue(0,360);
+		starfield->stars[i].ysin = GetRandomValue(0,360);
+	}
+}
+
+// New stars are scattered over the field and move at the speed of the first one (at rest in an empty field)
+void Resize_Starfield2D(Starfield2D *starfield, int count) {
+	if (count < 1) count = 1;
+	Stars *stars = (Stars *)realloc(starfield->stars, count*sizeof(Stars));
+	if (stars == NULL) return;
+
+	Stars first = (starfield->count > 0) ? stars[0] : (Stars) { 0 };
+	for(int i = starfield->count; i < count; i++) {
+		stars[i] = first;
+		stars[i].x = GetRandomValue(starfield->position.x , starfield->position.x + starfield->size.x);
+		stars[i].y = GetRandomValue(starfield->position.y , starfield->position.y + starfield->size.y);
+		stars[i].xsin = GetRandomValue(0,360);
+		stars[i].ysin = GetRandomValue(0,360);
+	}
+	starfield->stars = stars;
+	starfield->count = count;
+}
+
+void Unload_Starfield2D(Starfield2D *starfield) {
+	free(starfield->stars);
+	starfield->stars = NULL;
+	starfield->count = 0;
+}
+
+// Moves one star and returns where its sprite goes
+Vector2 Step_Star2D(Starfield2D *starfield, int i, Vector2 velocity) {
+	starfield->stars[i].x += starfield->stars[i].speedX * velocity.x;
+	starfield->stars[i].y += starfield->stars[i].speedY * velocity.y;
+
+	if( starfield->stars[i].x > ( starfield->position.x + starfield->size.x ) ) {
+		starfield->stars[i].x = starfield->position.x;
+		starfield->stars[i].y = GetRandomValue(starfield->position.y , starfield->position.y + starfield->size.y);
+	}
+
+	if( starfield->stars[i].y > ( starfield->position.y + starfield->size.y ) ) {
+		starfield->stars[i].y = starfield->position.y;
+		starfield->stars[i].x = GetRandomValue(starfield->position.x , starfield->position.x + starfield->size.x);
+	}
+
+	if( starfield->stars[i].x < starfield->position.x ) starfield->stars[i].x = starfield->position.x + starfield->size.x;
+	if( starfield->stars[i].y > ( starfield->position.y + starfield->size.y ) ) starfield->stars[i].y = starfield->position.y;
+	if( starfield->stars[i].y < starfield->position.y ) starfield->stars[i].y = starfield->position.y + starfield->size.y;
+
+	// DrawTexture takes integer positions
+	Vector2 pos = { (int)(starfield->stars[i].x + sin(starfield->stars[i].xsin)* velocity.y *8), (int)(starfield->stars[i].y + sin(starfield->stars[i].ysin)* velocity.y) };
+    starfield->stars[i].xsin += .1 ;
+    starfield->stars[i].ysin += .1 ;
+	return pos;
+}
+
+void Draw_Starfield2D(Starfield2D *starfield, Vector2 velocity) {
+	for(int i = 0; i < starfield->count; i++) {
+		Vector2 pos = Step_Star2D(starfield, i, velocity);
+		DrawTexture(starfield->sprite, pos.x, pos.y, WHITE);
+	}
+}
+
+// Same as Draw_Starfield2D, but the sprites go to an instance batch drawn later
+void Update_Starfield2D(Starfield2D *starfield, Vector2 velocity, SpriteBatch *batch) {
+	for(int i = 0; i < starfield->count; i++) {
+		Vector2 pos = Step_Star2D(starfield, i, velocity);
+		PushSprite(batch, pos.x, pos.y, WHITE);
+	}
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef __STARTUP_H__
+#define __STARTUP_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Startup graph
+// Startup as tasks with dependencies. Worker tasks (audio device, music, asset pack, starfields) each get a
+// thread that waits for their dependencies and runs; main thread tasks (window, textures, render targets, all
+// the GL work) run inline between BeginStartupTask() and EndStartupTask(), and Begin waits for their
+// dependencies in turn. Every task is timed from the top of main(), and ReportStartup() logs the timeline with
+// the time to audio and the time to the first frame.
+
+#define MAX_STARTUP_TASKS 16
+#define MAX_STARTUP_DEPENDENCIES 4
+#define STARTUP_TARGET_MS 300.0
+
+typedef struct StartupGraph StartupGraph;
+typedef void (*StartupTaskFn)(StartupGraph *graph, void *context);
+
+typedef struct StartupTask {
+	const char *name;
+	StartupTaskFn run;              // NULL for main thread tasks
+	void *context;
+	int dependencies[MAX_STARTUP_DEPENDENCIES];
+	int dependencyCount;
+	bool done;
+	double start;                   // ms since the graph was created
+	double end;
+	pthread_t thread;
+	bool started;                   // thread created
+} StartupTask;
+
+struct StartupGraph {
+	StartupTask tasks[MAX_STARTUP_TASKS];
+	int count;
+	struct timespec origin;
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	bool finishing;                 // main loop about to start, or startup failed
+	double audioMs;                 // first music samples queued, 0 until then
+	double firstFrameMs;
+};
+
+typedef struct StartupWorker {
+	StartupGraph *graph;
+	int task;
+} StartupWorker;
+
+// Create it first thing in main(), every time is relative to this
+static StartupGraph *CreateStartupGraph(void) {
+	StartupGraph *graph = (StartupGraph *)calloc(1, sizeof(StartupGraph));
+	clock_gettime(CLOCK_MONOTONIC, &graph->origin);
+	pthread_mutex_init(&graph->mutex, NULL);
+	pthread_cond_init(&graph->changed, NULL);
+	return graph;
+}
+
+static double StartupClock(const StartupGraph *graph) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - graph->origin.tv_sec)*1000.0 + (now.tv_nsec - graph->origin.tv_nsec)/1000000.0;
+}
+
+// 'run' NULL makes a main thread task
+static int AddStartupTask(StartupGraph *graph, const char *name, StartupTaskFn run, void *context) {
+	if (graph->count == MAX_STARTUP_TASKS) return -1;
+	StartupTask *task = &graph->tasks[graph->count];
+	task->name = name;
+	task->run = run;
+	task->context = context;
+	return graph->count++;
+}
+
+static void StartupDepends(StartupGraph *graph, int task, int dependency) {
+	StartupTask *t = &graph->tasks[task];
+	if (dependency >= 0 && t->dependencyCount < MAX_STARTUP_DEPENDENCIES) t->dependencies[t->dependencyCount++] = dependency;
+}
+
+// Both with the mutex held
+static bool StartupTaskReady(const StartupGraph *graph, int task) {
+	const StartupTask *t = &graph->tasks[task];
+	for (int i = 0; i < t->dependencyCount; i++) if (!graph->tasks[t->dependencies[i]].done) return false;
+	return true;
+}
+
+static void CompleteStartupTask(StartupGraph *graph, int task) {
+	graph->tasks[task].end = StartupClock(graph);
+	graph->tasks[task].done = true;
+	pthread_cond_broadcast(&graph->changed);
+}
+
+// Waits for the dependencies, false when startup was cancelled meanwhile
+static bool WaitStartupDependencies(StartupGraph *graph, int task) {
+	pthread_mutex_lock(&graph->mutex);
+	while (!StartupTaskReady(graph, task) && !graph->finishing) pthread_cond_wait(&graph->changed, &graph->mutex);
+	bool ready = StartupTaskReady(graph, task);
+	if (ready) graph->tasks[task].start = StartupClock(graph);
+	pthread_mutex_unlock(&graph->mutex);
+	return ready;
+}
+
+static void *StartupWorkerThread(void *arg) {
+	StartupWorker worker = *(StartupWorker *)arg;
+	free(arg);
+
+	StartupTask *task = &worker.graph->tasks[worker.task];
+	if (WaitStartupDependencies(worker.graph, worker.task)) task->run(worker.graph, task->context);
+
+	pthread_mutex_lock(&worker.graph->mutex);
+	CompleteStartupTask(worker.graph, worker.task);
+	pthread_mutex_unlock(&worker.graph->mutex);
+	return NULL;
+}
+
+// Starts a thread for every worker task, call once every task was added
+static void RunStartupGraph(StartupGraph *graph) {
+	for (int i = 0; i < graph->count; i++) {
+		StartupTask *task = &graph->tasks[i];
+		if (task->run == NULL) continue;
+
+		StartupWorker *worker = (StartupWorker *)malloc(sizeof(StartupWorker));
+		*worker = (StartupWorker) { graph, i };
+		task->started = pthread_create(&task->thread, NULL, StartupWorkerThread, worker) == 0;
+		if (!task->started) {
+			// No thread, run it here once its dependencies are done
+			free(worker);
+			TraceLog(LOG_WARNING, "STARTUP: no thread for %s, running it on the main thread", task->name);
+		}
+	}
+}
+
+static void EndStartupTask(StartupGraph *graph, int task) {
+	pthread_mutex_lock(&graph->mutex);
+	CompleteStartupTask(graph, task);
+	pthread_mutex_unlock(&graph->mutex);
+}
+
+// Blocks until a task is done, worker tasks that got no thread run here
+static void WaitStartupTask(StartupGraph *graph, int task) {
+	StartupTask *t = &graph->tasks[task];
+	if (t->run != NULL && !t->started) {
+		pthread_mutex_lock(&graph->mutex);
+		bool done = t->done;
+		pthread_mutex_unlock(&graph->mutex);
+		if (!done) {
+			if (WaitStartupDependencies(graph, task)) t->run(graph, t->context);
+			EndStartupTask(graph, task);
+		}
+		return;
+	}
+
+	pthread_mutex_lock(&graph->mutex);
+	while (!t->done) pthread_cond_wait(&graph->changed, &graph->mutex);
+	pthread_mutex_unlock(&graph->mutex);
+}
+
+// Main thread tasks must begin in an order where their main thread dependencies are already done
+static void BeginStartupTask(StartupGraph *graph, int task) {
+	StartupTask *t = &graph->tasks[task];
+	for (int i = 0; i < t->dependencyCount; i++) WaitStartupTask(graph, t->dependencies[i]);
+	WaitStartupDependencies(graph, task);
+}
+
+// Long running worker tasks (the music keeps its stream fed until the main loop takes over) poll this
+static bool StartupFinishing(StartupGraph *graph) {
+	pthread_mutex_lock(&graph->mutex);
+	bool finishing = graph->finishing;
+	pthread_mutex_unlock(&graph->mutex);
+	return finishing;
+}
+
+static void MarkStartupAudio(StartupGraph *graph) {
+	pthread_mutex_lock(&graph->mutex);
+	if (graph->audioMs == 0) graph->audioMs = StartupClock(graph);
+	pthread_mutex_unlock(&graph->mutex);
+}
+
+// Tells the long running tasks to return, then joins every thread. Tasks still waiting on their dependencies
+// (startup failed) return without running.
+static void FinishStartupGraph(StartupGraph *graph) {
+	pthread_mutex_lock(&graph->mutex);
+	graph->finishing = true;
+	pthread_cond_broadcast(&graph->changed);
+	pthread_mutex_unlock(&graph->mutex);
+
+	for (int i = 0; i < graph->count; i++) {
+		StartupTask *task = &graph->tasks[i];
+		if (task->run == NULL) continue;
+		if (task->started) pthread_join(task->thread, NULL);
+		else WaitStartupTask(graph, i);
+		task->started = false;
+	}
+}
+
+// Call after the first EndDrawing(); logs the timeline and frees the graph
+static void ReportStartup(StartupGraph *graph) {
+	graph->firstFrameMs = StartupClock(graph);
+
+	for (int i = 0; i < graph->count; i++) {
+		StartupTask *task = &graph->tasks[i];
+		TraceLog(LOG_INFO, "STARTUP: %-16s %-6s %7.1f ms -> %7.1f ms (%.1f ms)", task->name, task->run != NULL ? "worker" : "main",
+			task->start, task->end, task->end - task->start);
+	}
+	TraceLog(LOG_INFO, "STARTUP: time to audio %.1f ms, time to first frame %.1f ms", graph->audioMs, graph->firstFrameMs);
+	if (graph->firstFrameMs > STARTUP_TARGET_MS) TraceLog(LOG_WARNING, "STARTUP: first frame after %.0f ms, over the %.0f ms target", graph->firstFrameMs, STARTUP_TARGET_MS);
+
+	pthread_mutex_destroy(&graph->mutex);
+	pthread_cond_destroy(&graph->changed);
+	free(graph);
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef __STRESS_H__
+#define __STRESS_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------------------------------------------
+// Stress mode
+// Command line multipliers for the size of each effect, and an automatic sweep that doubles one effect at a
+// time, measures the frame time and writes a table of frame time against size:
+//
+//     ./demo --stars 4 --copper 2 --flag 2 --logo 1
+//     ./demo --sweep [max multiplier] [--sweep-out stress.txt]
+
+typedef enum { STRESS_STARS = 0, STRESS_COPPER, STRESS_FLAG, STRESS_LOGO, STRESS_EFFECTS } StressEffect;
+
+static const char *stressEffectNames[STRESS_EFFECTS] = { "stars", "copper", "flag", "logo" };
+static const char *stressEffectUnits[STRESS_EFFECTS] = { "sprites", "quads", "cells", "rows" };
+
+// Sizes at multiplier 1: 8 fields of MAXSTARS, 160 columns x 11 layers, 32x12 cells, 108 rows
+static const int stressBaseSize[STRESS_EFFECTS] = { 8*8, 160*11, 32*12, 108 };
+
+#define STRESS_WARMUP_FRAMES 30
+#define STRESS_MEASURE_FRAMES 120
+
+typedef struct StressConfig {
+	int scale[STRESS_EFFECTS];      // 1 unless given on the command line
+	bool sweep;
+	int sweepMax;                   // largest multiplier of the sweep
+	const char *output;
+} StressConfig;
+
+typedef struct StressSweep {
+	StressConfig config;
+	int effect;                     // effect being swept
+	int multiplier;
+	int frame;                      // frames run at this step, warm up included
+	float times[STRESS_MEASURE_FRAMES];
+	FILE *file;
+	bool done;
+} StressSweep;
+
+// The flag multiplier applies to both sides of the grid
+static int StressSize(StressEffect effect, int multiplier) {
+	int size = stressBaseSize[effect]*multiplier;
+	if (effect == STRESS_FLAG) size *= multiplier;
+	return size;
+}
+
+static StressConfig ParseStressArgs(int argc, char **argv) {
+	StressConfig config = { { 1, 1, 1, 1 }, false, 64, "stress.txt" };
+
+	for (int i = 1; i < argc; i++) {
+		bool found = false;
+		for (int e = 0; e < STRESS_EFFECTS; e++) {
+			if (argv[i][0] == '-' && argv[i][1] == '-' && strcmp(argv[i] + 2, stressEffectNames[e]) == 0 && i + 1 < argc) {
+				config.scale[e] = atoi(argv[++i]);
+				if (config.scale[e] < 1) config.scale[e] = 1;
+				found = true;
+			}
+		}
+		if (found) continue;
+
+		if (strcmp(argv[i], "--sweep") == 0) {
+			config.sweep = true;
+			if (i + 1 < argc && atoi(argv[i + 1]) > 0) config.sweepMax = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--sweep-out") == 0 && i + 1 < argc) {
+			config.output = argv[++i];
+		}
+	}
+	return config;
+}
+
+static bool StressActive(const StressConfig *config) {
+	if (config->sweep) return true;
+	for (int e = 0; e < STRESS_EFFECTS; e++) if (config->scale[e] != 1) return true;
+	return false;
+}
+
+static StressSweep *StartStressSweep(StressConfig config) {
+	StressSweep *sweep = (StressSweep *)calloc(1, sizeof(StressSweep));
+	sweep->config = config;
+	sweep->multiplier = 1;
+
+	sweep->file = fopen(config.output, "w");
+	if (sweep->file == NULL) TraceLog(LOG_WARNING, "STRESS: could not write %s", config.output);
+
+	const char *header = "effect   multiplier        size  unit       mean ms    p50 ms    p99 ms    max ms      fps\n";
+	printf("%s", header);
+	if (sweep->file != NULL) fprintf(sweep->file, "%s", header);
+	return sweep;
+}
+
+static void CloseStressSweep(StressSweep *sweep) {
+	if (sweep->file != NULL) fclose(sweep->file);
+	free(sweep);
+}
+
+// Multipliers for the current step: the swept effect at its step, the others as given on the command line
+static void StressSweepScale(const StressSweep *sweep, int *scale) {
+	for (int e = 0; e < STRESS_EFFECTS; e++) scale[e] = sweep->config.scale[e];
+	if (!sweep->done) scale[sweep->effect] = sweep->multiplier;
+}
+
+static int CompareStressTimes(const void *a, const void *b) {
+	float ta = *(const float *)a, tb = *(const float *)b;
+	return (ta > tb) - (ta < tb);
+}
+
+static void WriteStressRow(StressSweep *sweep) {
+	float *t = sweep->times;
+	int n = STRESS_MEASURE_FRAMES;
+	double sum = 0;
+	for (int i = 0; i < n; i++) sum += t[i];
+	qsort(t, n, sizeof(float), CompareStressTimes);
+
+	double mean = sum/n;
+	char row[160];
+	snprintf(row, sizeof(row), "%-8s %10i %11i  %-7s %10.3f %9.3f %9.3f %9.3f %8.1f\n",
+		stressEffectNames[sweep->effect], sweep->multiplier, StressSize((StressEffect)sweep->effect, sweep->multiplier),
+		stressEffectUnits[sweep->effect], mean*1000.0, t[n/2]*1000.0, t[(n*99)/100]*1000.0, t[n - 1]*1000.0, 1.0/mean);
+
+	printf("%s", row);
+	if (sweep->file != NULL) { fprintf(sweep->file, "%s", row); fflush(sweep->file); }
+}
+
+// Feeds the time of the last frame, returns false once every effect was swept
+static bool StepStressSweep(StressSweep *sweep, float frameTime) {
+	if (sweep->done) return false;
+
+	if (sweep->frame >= STRESS_WARMUP_FRAMES) sweep->times[sweep->frame - STRESS_WARMUP_FRAMES] = frameTime;
+	if (++sweep->frame < STRESS_WARMUP_FRAMES + STRESS_MEASURE_FRAMES) return true;
+
+	WriteStressRow(sweep);
+	sweep->frame = 0;
+	sweep->multiplier *= 2;
+	if (sweep->multiplier > sweep->config.sweepMax) {
+		sweep->multiplier = 1;
+		if (++sweep->effect == STRESS_EFFECTS) sweep->done = true;
+	}
+	return !sweep->done;
+}
+
+#endif
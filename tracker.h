@@ -0,0 +1,1032 @@
+#ifndef __TRACKER_H__
+#define __TRACKER_H__
+
+#pragma once
+
+#include <raylib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------
+// Tracker modules
+// MOD (ProTracker and its 1 to 32 channel variants) and XM (FastTracker 2) songs, a few KB instead of a decoded
+// or streamed ogg. Both load into one song layout: patterns of cells, instruments mapping notes to samples, and
+// samples converted to floats. The player runs the song tick by tick (the usual effects: portamento, vibrato,
+// tremolo, arpeggio, volume and panning slides, offsets, jumps, breaks, loops, delays, XM volume envelopes and
+// the volume column) and the mixer resamples every channel with linear interpolation, 4 frames at a time with
+// SSE2 or 8 with AVX2, into one stereo float buffer.
+//
+// A mixer thread keeps TRACKER_BUFFERS buffers of 16 bit frames ahead; the main loop only copies them into the
+// raylib audio stream, raylib 3.5 has no stream callback to mix in.
+//
+//     ./demo --module song.xm                         plays a module instead of NTMMEG.ogg
+//     ./demo --write-pack assets.pak --module song.xm embeds it, played whenever the pack is used
+
+#define TRACKER_MAX_CHANNELS 32
+#define TRACKER_RATE 48000
+#define TRACKER_BUFFERS 4               // mixed ahead of the audio stream
+#define TRACKER_GUARD 8                 // frames after every sample, read by the interpolation
+#define TRACKER_RUN 256                 // frames mixed per call, keeps float positions exact enough
+#define TRACKER_CHUNK 1024              // frames mixed in floats before conversion
+#define TRACKER_KEY_OFF 97
+#define TRACKER_MAX_STEP (32LL << 32)   // 32 frames of sample per frame of output
+
+typedef struct TrackerCell {
+	unsigned char note;             // 1..96, C-0 is 1, TRACKER_KEY_OFF or 0
+	unsigned char instrument;       // 1 based, 0 for none
+	unsigned char volume;           // XM volume column, 0 for none
+	unsigned char effect;           // 0x00..0x0f like MOD, XM letters G..X follow as 0x10..0x21
+	unsigned char param;
+} TrackerCell;
+
+typedef struct TrackerPattern {
+	int rows;
+	TrackerCell *cells;             // rows*channels
+} TrackerPattern;
+
+typedef struct TrackerSample {
+	float *data;                    // length + TRACKER_GUARD frames
+	int length;                     // frames
+	int loopStart;
+	int loopEnd;                    // loopStart when the sample does not loop
+	bool pingPong;
+	int volume;                     // 0..64
+	int finetune;                   // -128..127, 1/128 semitone
+	int relativeNote;
+	int panning;                    // 0..255
+} TrackerSample;
+
+enum { TRACKER_ENVELOPE_ON = 1, TRACKER_ENVELOPE_SUSTAIN = 2, TRACKER_ENVELOPE_LOOP = 4 };
+
+typedef struct TrackerEnvelope {
+	unsigned short x[12];           // ticks
+	unsigned short y[12];           // 0..64
+	int points;
+	int sustain;
+	int loopStart;
+	int loopEnd;
+	int flags;
+} TrackerEnvelope;
+
+typedef struct TrackerInstrument {
+	unsigned char sampleMap[96];    // note to sample of the instrument
+	int firstSample;                // in the song
+	int sampleCount;
+	TrackerEnvelope volume;
+	int fadeout;
+} TrackerInstrument;
+
+typedef struct TrackerSong {
+	char name[24];
+	bool xm;
+	bool linear;                    // XM linear frequencies, Amiga periods otherwise
+	int channels;
+	int length;                     // orders
+	int restart;
+	int speed;
+	int bpm;
+	unsigned char orders[256];
+	int patternCount;
+	int instrumentCount;
+	int sampleCount;
+	TrackerPattern *patterns;
+	TrackerInstrument *instruments;
+	TrackerSample *samples;
+	size_t bytes;                   // allocated for the song
+} TrackerSong;
+
+// One channel's sample playing, what the mixer sees
+typedef struct TrackerVoice {
+	const TrackerSample *sample;    // NULL when silent
+	int64_t position;               // 32.32 frames
+	int64_t step;                   // negative playing a ping-pong loop backwards
+	float left;
+	float right;
+} TrackerVoice;
+
+// Mixes 'frames' frames of 'data' from x0 by 'step' into interleaved stereo 'out'
+typedef void (*TrackerMixFn)(const float *data, float x0, float step, int frames, float left, float right, float *out);
+
+typedef struct TrackerChannel {
+	TrackerVoice voice;
+	TrackerCell cell;               // row being played
+	const TrackerInstrument *instrument;
+	const TrackerSample *sample;
+	int period;                     // 1/64 semitone (linear) or quarter Amiga periods
+	int targetPeriod;               // tone portamento
+	int volume;                     // 0..64
+	int panning;                    // 0..255
+	bool keyOn;
+	int envelopeTick;
+	int fadeout;                    // 65536 until the key is released
+
+	int portaUp, portaDown, portaSpeed;
+	int volumeSlide, globalSlide, panSlide;
+	int vibratoSpeed, vibratoDepth, vibratoPos;
+	int tremoloSpeed, tremoloDepth, tremoloPos;
+	int offset;
+	int loopRow, loopCount;
+
+	int arpeggio;                   // semitones, this tick
+	int vibratoDelta;
+	int tremoloDelta;
+} TrackerChannel;
+
+typedef struct TrackerPlayer {
+	const TrackerSong *song;
+	int rate;
+	TrackerMixFn mix;
+	TrackerChannel channels[TRACKER_MAX_CHANNELS];
+	int order;
+	int row;
+	int tick;
+	int speed;
+	int bpm;
+	int tickFrames;                 // left in the current tick
+	int globalVolume;               // 0..64
+	float gain;
+
+	int rowRepeat;                  // pattern delay
+	bool repeating;
+	bool jump;
+	int jumpOrder;
+	bool rowBreak;
+	int breakRow;
+	bool loopJump;
+	int loopRow;
+
+	float mixBuffer[TRACKER_CHUNK*2];
+} TrackerPlayer;
+
+typedef struct TrackerStream {
+	TrackerSong song;
+	TrackerPlayer player;
+	int frames;                     // per buffer
+	short *buffers[TRACKER_BUFFERS];
+	int readIndex;
+	int filled;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	bool quit;
+	double mixSeconds;              // mixer thread busy time
+	long long mixedFrames;
+} TrackerStream;
+
+typedef struct TrackerConfig {
+	const char *module;
+} TrackerConfig;
+
+static TrackerConfig ParseTrackerArgs(int argc, char **argv) {
+	TrackerConfig config = { NULL };
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--module") == 0 && i + 1 < argc) config.module = argv[++i];
+	}
+	return config;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Loading
+
+static unsigned int TrackerBE16(const unsigned char *p) { return p[0] << 8 | p[1]; }
+static unsigned int TrackerLE16(const unsigned char *p) { return p[0] | p[1] << 8; }
+static unsigned int TrackerLE32(const unsigned char *p) { return p[0] | p[1] << 8 | p[2] << 16 | (unsigned int)p[3] << 24; }
+
+// NULL when it could not be allocated, the loaders then fail and the song is unloaded
+static void *TrackerAlloc(TrackerSong *song, size_t bytes) {
+	song->bytes += bytes;
+	void *memory = calloc(1, bytes);
+	if (memory == NULL) TraceLog(LOG_WARNING, "TRACKER: could not allocate %i KB", (int)(bytes/1024));
+	return memory;
+}
+
+static void UnloadTrackerSong(TrackerSong *song) {
+	for (int i = 0; song->patterns != NULL && i < song->patternCount; i++) free(song->patterns[i].cells);
+	for (int i = 0; song->samples != NULL && i < song->sampleCount; i++) free(song->samples[i].data);
+	free(song->patterns);
+	free(song->instruments);
+	free(song->samples);
+	*song = (TrackerSong) { 0 };
+}
+
+// Fills the guard after the end: the loop start for loops, so interpolation runs across the loop point
+static void FinishTrackerSample(TrackerSample *s) {
+	if (s->loopEnd > s->length) s->loopEnd = s->length;
+	if (s->loopStart < 0 || s->loopEnd <= s->loopStart + 1) s->loopStart = s->loopEnd = 0;
+	int end = s->loopEnd > s->loopStart ? s->loopEnd : s->length;
+	for (int i = 0; i < TRACKER_GUARD; i++) {
+		float v = 0.0f;
+		if (s->loopEnd > s->loopStart) v = s->pingPong ? s->data[s->loopEnd - 1] : s->data[s->loopStart + i%(s->loopEnd - s->loopStart)];
+		s->data[end + i] = v;
+	}
+}
+
+// The note, 1 based, closest to a ProTracker period (428 is C-4 here, sampled at about 8287 Hz)
+static int TrackerPeriodNote(unsigned int period) {
+	int note = 48 + (int)lrint(12.0*log2(428.0/period));
+	return (note < 0 ? 0 : note > 95 ? 95 : note) + 1;
+}
+
+static bool LoadModSong(const unsigned char *data, size_t size, TrackerSong *song) {
+	if (size < 1084) return false;
+
+	const unsigned char *tag = data + 1080;
+	int channels = 0;
+	if (memcmp(tag, "M.K.", 4) == 0 || memcmp(tag, "M!K!", 4) == 0 || memcmp(tag, "FLT4", 4) == 0 || memcmp(tag, "4CHN", 4) == 0) channels = 4;
+	else if (memcmp(tag, "FLT8", 4) == 0) channels = 8;
+	else if (tag[0] >= '1' && tag[0] <= '9' && memcmp(tag + 1, "CHN", 3) == 0) channels = tag[0] - '0';
+	else if (tag[0] >= '0' && tag[0] <= '9' && tag[1] >= '0' && tag[1] <= '9' && memcmp(tag + 2, "CH", 2) == 0) channels = (tag[0] - '0')*10 + tag[1] - '0';
+	if (channels < 1 || channels > TRACKER_MAX_CHANNELS) return false;
+
+	memcpy(song->name, data, 20);
+	song->channels = channels;
+	song->length = data[950] >= 1 && data[950] <= 128 ? data[950] : 1;
+	song->restart = data[951] < song->length ? data[951] : 0;
+	song->speed = 6;
+	song->bpm = 125;
+	memcpy(song->orders, data + 952, 128);
+	for (int i = 0; i < 128; i++) if (song->orders[i] + 1 > song->patternCount) song->patternCount = song->orders[i] + 1;
+
+	size_t patternBytes = (size_t)64*channels*4;
+	if (1084 + song->patternCount*patternBytes > size) return false;
+	song->patterns = (TrackerPattern *)TrackerAlloc(song, song->patternCount*sizeof(TrackerPattern));
+	if (song->patterns == NULL) return false;
+	for (int i = 0; i < song->patternCount; i++) {
+		const unsigned char *p = data + 1084 + i*patternBytes;
+		TrackerPattern *pattern = &song->patterns[i];
+		pattern->rows = 64;
+		pattern->cells = (TrackerCell *)TrackerAlloc(song, (size_t)64*channels*sizeof(TrackerCell));
+		if (pattern->cells == NULL) return false;
+		for (int c = 0; c < 64*channels; c++, p += 4) {
+			unsigned int period = (p[0] & 0x0f) << 8 | p[1];
+			pattern->cells[c] = (TrackerCell) { (unsigned char)(period ? TrackerPeriodNote(period) : 0), (unsigned char)((p[0] & 0xf0) | p[2] >> 4), 0, (unsigned char)(p[2] & 0x0f), p[3] };
+		}
+	}
+
+	// One instrument per sample, samples follow the patterns
+	song->instrumentCount = song->sampleCount = 31;
+	song->instruments = (TrackerInstrument *)TrackerAlloc(song, 31*sizeof(TrackerInstrument));
+	song->samples = (TrackerSample *)TrackerAlloc(song, 31*sizeof(TrackerSample));
+	if (song->instruments == NULL || song->samples == NULL) return false;
+	size_t offset = 1084 + song->patternCount*patternBytes;
+	for (int i = 0; i < 31; i++) {
+		const unsigned char *h = data + 20 + i*30;
+		TrackerSample *s = &song->samples[i];
+		int length = TrackerBE16(h + 22)*2;
+		if ((size_t)length > size - offset) length = (int)(size - offset);          // truncated files play what is there
+		int finetune = h[24] & 0x0f;
+		*s = (TrackerSample) { NULL, length, (int)TrackerBE16(h + 26)*2, (int)(TrackerBE16(h + 26) + TrackerBE16(h + 28))*2, false,
+			h[25] > 64 ? 64 : h[25], (finetune > 7 ? finetune - 16 : finetune)*16, 0, 128 };
+		if (TrackerBE16(h + 28) <= 1) s->loopEnd = s->loopStart;
+		s->data = (float *)TrackerAlloc(song, (length + TRACKER_GUARD)*sizeof(float));
+		if (s->data == NULL) return false;
+		for (int j = 0; j < length; j++) s->data[j] = (signed char)data[offset + j]/128.0f;
+		offset += length;
+		FinishTrackerSample(s);
+
+		song->instruments[i].firstSample = i;
+		song->instruments[i].sampleCount = 1;
+	}
+	return true;
+}
+
+static bool LoadXmSong(const unsigned char *data, size_t size, TrackerSong *song) {
+	if (size < 80 || memcmp(data, "Extended Module: ", 17) != 0) return false;
+	size_t headerSize = TrackerLE32(data + 60);
+	if (60 + headerSize > size || headerSize < 20 + 256) return false;
+
+	memcpy(song->name, data + 17, 20);
+	song->xm = true;
+	song->length = TrackerLE16(data + 64);
+	song->restart = TrackerLE16(data + 66);
+	song->channels = TrackerLE16(data + 68);
+	song->patternCount = TrackerLE16(data + 70);
+	song->instrumentCount = TrackerLE16(data + 72);
+	song->linear = TrackerLE16(data + 74) & 1;
+	song->speed = TrackerLE16(data + 76);
+	song->bpm = TrackerLE16(data + 78);
+	memcpy(song->orders, data + 80, 256);
+	if (song->channels < 1 || song->channels > TRACKER_MAX_CHANNELS || song->length < 1 || song->length > 256 || song->patternCount > 256 || song->instrumentCount > 128) return false;
+	if (song->restart >= song->length) song->restart = 0;
+	if (song->speed < 1 || song->speed > 31) song->speed = 6;
+	if (song->bpm < 32 || song->bpm > 255) song->bpm = 125;
+
+	size_t offset = 60 + headerSize;
+	song->patterns = (TrackerPattern *)TrackerAlloc(song, song->patternCount*sizeof(TrackerPattern));
+	if (song->patterns == NULL) return false;
+	for (int i = 0; i < song->patternCount; i++) {
+		if (offset + 9 > size) return false;
+		size_t length = TrackerLE32(data + offset);
+		int rows = TrackerLE16(data + offset + 5);
+		size_t packed = TrackerLE16(data + offset + 7);
+		offset += length;
+		if (length < 9 || rows < 1 || rows > 256 || offset > size || packed > size - offset) return false;
+
+		TrackerPattern *pattern = &song->patterns[i];
+		pattern->rows = rows;
+		pattern->cells = (TrackerCell *)TrackerAlloc(song, (size_t)rows*song->channels*sizeof(TrackerCell));
+		if (pattern->cells == NULL) return false;
+		const unsigned char *p = data + offset, *end = p + packed;
+		for (int c = 0; c < rows*song->channels && packed > 0 && p < end; c++) {
+			unsigned char fields[5] = { 0 };
+			unsigned char mask = 0x1f;
+			if (*p & 0x80) mask = *p++ & 0x1f;
+			for (int f = 0; f < 5; f++) if ((mask & (1 << f)) && p < end) fields[f] = *p++;
+			TrackerCell *cell = &pattern->cells[c];
+			*cell = (TrackerCell) { fields[0] <= TRACKER_KEY_OFF ? fields[0] : 0, fields[1], fields[2], fields[3], fields[4] };
+		}
+		offset += packed;
+	}
+
+	song->instruments = (TrackerInstrument *)TrackerAlloc(song, (song->instrumentCount + 1)*sizeof(TrackerInstrument));
+	if (song->instruments == NULL) return false;
+	for (int i = 0; i < song->instrumentCount; i++) {
+		if (offset + 29 > size) return false;
+		const unsigned char *h = data + offset;
+		size_t instrumentSize = TrackerLE32(h);
+		int samples = TrackerLE16(h + 27);
+		TrackerInstrument *instrument = &song->instruments[i];
+		instrument->firstSample = song->sampleCount;
+		if (samples == 0) {
+			offset += instrumentSize;
+			continue;
+		}
+		if (samples > 16 || instrumentSize < 241 || offset + instrumentSize > size) return false;
+
+		size_t sampleHeaderSize = TrackerLE32(h + 29);
+		memcpy(instrument->sampleMap, h + 33, 96);
+		TrackerEnvelope *e = &instrument->volume;
+		e->points = h[225] > 12 ? 12 : h[225];
+		for (int j = 0; j < 12; j++) {
+			e->x[j] = TrackerLE16(h + 129 + j*4);
+			e->y[j] = TrackerLE16(h + 131 + j*4) > 64 ? 64 : TrackerLE16(h + 131 + j*4);
+		}
+		e->sustain = h[227];
+		e->loopStart = h[228];
+		e->loopEnd = h[229];
+		e->flags = e->points >= 2 ? h[233] : 0;
+		if (e->sustain >= e->points) e->flags &= ~TRACKER_ENVELOPE_SUSTAIN;
+		if (e->loopStart >= e->points || e->loopEnd >= e->points || e->loopStart > e->loopEnd) e->flags &= ~TRACKER_ENVELOPE_LOOP;
+		instrument->fadeout = TrackerLE16(h + 239);
+		instrument->sampleCount = samples;
+		offset += instrumentSize;
+
+		// Sample headers, then every sample's delta coded data
+		if (offset + samples*sampleHeaderSize > size || sampleHeaderSize < 18) return false;
+		TrackerSample *grown = (TrackerSample *)realloc(song->samples, (song->sampleCount + samples)*sizeof(TrackerSample));
+		if (grown == NULL) {
+			TraceLog(LOG_WARNING, "TRACKER: could not allocate %i more samples", samples);
+			return false;
+		}
+		song->samples = grown;
+		song->bytes += samples*sizeof(TrackerSample);
+		size_t dataOffset = offset + samples*sampleHeaderSize;
+		for (int j = 0; j < samples; j++) {
+			const unsigned char *sh = data + offset + j*sampleHeaderSize;
+			TrackerSample *s = &song->samples[song->sampleCount++];
+			int type = sh[14];
+			int bytesPerFrame = (type & 0x10) ? 2 : 1;
+			size_t bytes = TrackerLE32(sh);
+			if (bytes > size - dataOffset) bytes = size - dataOffset;
+			int length = (int)(bytes/bytesPerFrame);
+			*s = (TrackerSample) { NULL, length, (int)(TrackerLE32(sh + 4)/bytesPerFrame), (int)((TrackerLE32(sh + 4) + TrackerLE32(sh + 8))/bytesPerFrame),
+				(type & 3) == 2, sh[12] > 64 ? 64 : sh[12], (signed char)sh[13], (signed char)sh[16], sh[15] };
+			if ((type & 3) == 0) s->loopEnd = s->loopStart;
+			s->data = (float *)TrackerAlloc(song, (length + TRACKER_GUARD)*sizeof(float));
+			if (s->data == NULL) return false;
+
+			const unsigned char *p = data + dataOffset;
+			int value = 0;
+			for (int k = 0; k < length; k++) {
+				if (bytesPerFrame == 2) {
+					value = (short)(value + (short)TrackerLE16(p + k*2));
+					s->data[k] = value/32768.0f;
+				} else {
+					value = (signed char)(value + (signed char)p[k]);
+					s->data[k] = value/128.0f;
+				}
+			}
+			dataOffset += TrackerLE32(sh) < size - dataOffset ? TrackerLE32(sh) : size - dataOffset;
+			FinishTrackerSample(s);
+		}
+		offset = dataOffset;
+	}
+	return true;
+}
+
+// MOD or XM from memory; the song keeps no pointer into 'data'
+static bool LoadTrackerSong(const unsigned char *data, size_t size, TrackerSong *song) {
+	*song = (TrackerSong) { 0 };
+	bool loaded = (size >= 17 && memcmp(data, "Extended Module: ", 17) == 0) ? LoadXmSong(data, size, song) : LoadModSong(data, size, song);
+	if (!loaded) UnloadTrackerSong(song);
+	return loaded;
+}
+
+static unsigned char *ReadTrackerFile(const char *fileName, size_t *size) {
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL) return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	unsigned char *data = length > 0 ? (unsigned char *)malloc(length) : NULL;
+	if (data != NULL && fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	*size = data != NULL ? (size_t)length : 0;
+	return data;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Mixer
+
+// Scalar reference, also the tail of the SIMD runs
+static void MixTrackerRunScalar(const float *data, float x0, float step, int frames, float left, float right, float *out) {
+	for (int k = 0; k < frames; k++) {
+		float x = x0 + (float)k*step;
+		int i = (int)x;
+		float f = x - (float)i;
+		float s = data[i] + (data[i + 1] - data[i])*f;
+		out[2*k] += s*left;
+		out[2*k + 1] += s*right;
+	}
+}
+
+#if defined(__SSE2__)
+static void MixTrackerRunSse2(const float *data, float x0, float step, int frames, float left, float right, float *out) {
+	__m128 base = _mm_set1_ps(x0), steps = _mm_set1_ps(step), lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	__m128 l = _mm_set1_ps(left), r = _mm_set1_ps(right);
+	int k = 0;
+
+	for (; k + 4 <= frames; k += 4) {
+		__m128 x = _mm_add_ps(base, _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)k), lanes), steps));
+		__m128i i = _mm_cvttps_epi32(x);
+		__m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+		int index[4];
+		_mm_storeu_si128((__m128i *)index, i);
+		__m128 s0 = _mm_set_ps(data[index[3]], data[index[2]], data[index[1]], data[index[0]]);
+		__m128 s1 = _mm_set_ps(data[index[3] + 1], data[index[2] + 1], data[index[1] + 1], data[index[0] + 1]);
+		__m128 s = _mm_add_ps(s0, _mm_mul_ps(_mm_sub_ps(s1, s0), f));
+
+		__m128 sl = _mm_mul_ps(s, l), sr = _mm_mul_ps(s, r);
+		float *o = out + 2*k;
+		_mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_unpacklo_ps(sl, sr)));
+		_mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_unpackhi_ps(sl, sr)));
+	}
+	if (k < frames) MixTrackerRunScalar(data, x0 + (float)k*step, step, frames - k, left, right, out + 2*k);
+}
+#endif
+
+#if defined(__AVX2__)
+static void MixTrackerRunAvx2(const float *data, float x0, float step, int frames, float left, float right, float *out) {
+	__m256 base = _mm256_set1_ps(x0), steps = _mm256_set1_ps(step), lanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+	__m256 l = _mm256_set1_ps(left), r = _mm256_set1_ps(right);
+	int k = 0;
+
+	for (; k + 8 <= frames; k += 8) {
+		__m256 x = _mm256_add_ps(base, _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)k), lanes), steps));
+		__m256i i = _mm256_cvttps_epi32(x);
+		__m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(i));
+		__m256 s0 = _mm256_i32gather_ps(data, i, 4);
+		__m256 s1 = _mm256_i32gather_ps(data + 1, i, 4);
+		__m256 s = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_sub_ps(s1, s0), f));
+
+		// Interleave within the 128 bit halves, then put the halves in frame order
+		__m256 sl = _mm256_mul_ps(s, l), sr = _mm256_mul_ps(s, r);
+		__m256 lo = _mm256_unpacklo_ps(sl, sr), hi = _mm256_unpackhi_ps(sl, sr);
+		float *o = out + 2*k;
+		_mm256_storeu_ps(o, _mm256_add_ps(_mm256_loadu_ps(o), _mm256_permute2f128_ps(lo, hi, 0x20)));
+		_mm256_storeu_ps(o + 8, _mm256_add_ps(_mm256_loadu_ps(o + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+	}
+	if (k < frames) MixTrackerRunScalar(data, x0 + (float)k*step, step, frames - k, left, right, out + 2*k);
+}
+#endif
+
+#if defined(__AVX2__)
+	#define MixTrackerRun MixTrackerRunAvx2
+#elif defined(__SSE2__)
+	#define MixTrackerRun MixTrackerRunSse2
+#else
+	#define MixTrackerRun MixTrackerRunScalar
+#endif
+
+// Adds 'frames' frames of a voice to 'out', in runs that stop at the sample end or loop points
+static void MixTrackerVoice(TrackerVoice *v, float *out, int frames, TrackerMixFn mix) {
+	while (frames > 0 && v->sample != NULL && v->step != 0) {
+		const TrackerSample *s = v->sample;
+		bool looped = s->loopEnd > s->loopStart;
+		int64_t start = (int64_t)s->loopStart << 32, end = (int64_t)(looped ? s->loopEnd : s->length) << 32;
+
+		// Frames before the position leaves [start, end)
+		int64_t n = (v->step > 0) ? (end - v->position + v->step - 1)/v->step : (v->position - start)/-v->step + 1;
+		if (n > frames) n = frames;
+		if (n > TRACKER_RUN) n = TRACKER_RUN;
+		if (n > 0) {
+			// Relative to the lowest frame read, so the float positions stay small and positive
+			int64_t first = v->position, last = v->position + (n - 1)*v->step;
+			int64_t base = (first < last ? first : last) >> 32;
+			float x0 = (float)((first - (base << 32))*(1.0/4294967296.0));
+			mix(s->data + base, x0, (float)(v->step*(1.0/4294967296.0)), (int)n, v->left, v->right, out);
+			v->position += n*v->step;
+			out += 2*n;
+			frames -= (int)n;
+		}
+
+		if (v->step > 0 && v->position >= end) {
+			if (!looped) v->sample = NULL;
+			else if (!s->pingPong) v->position = start + (v->position - start)%(end - start);
+			else {
+				v->position = 2*end - v->position;
+				if (v->position < start) v->position = start;
+				v->step = -v->step;
+			}
+		} else if (v->step < 0 && v->position < start) {
+			v->position = 2*start - v->position;
+			if (v->position >= end) v->position = end - 1;
+			v->step = -v->step;
+		}
+	}
+}
+
+// Interleaved stereo floats to 16 bit, saturated
+static void ConvertTrackerFrames(const float *in, short *out, int samples) {
+	int i = 0;
+#if defined(__SSE2__)
+	__m128 scale = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= samples; i += 8) {
+		__m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+		__m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+		_mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(a, b));
+	}
+#endif
+	for (; i < samples; i++) {
+		float v = in[i]*32767.0f;
+		out[i] = (short)(v > 32767.0f ? 32767 : v < -32768.0f ? -32768 : lrintf(v));
+	}
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Player
+
+static const unsigned char trackerSine[32] = {
+	0, 24, 49, 74, 97, 120, 141, 161, 180, 197, 212, 224, 235, 244, 250, 253,
+	255, 253, 250, 244, 235, 224, 212, 197, 180, 161, 141, 120, 97, 74, 49, 24
+};
+
+static int TrackerNotePeriod(const TrackerSong *song, int note, int finetune) {
+	if (song->linear) return 7680 - note*64 - finetune/2;
+	return (int)lrint(1712.0*exp2((48.0 - note - finetune/128.0)/12.0));
+}
+
+static double TrackerPeriodFrequency(const TrackerSong *song, int period) {
+	if (song->linear) return 8363.0*exp2((4608 - period)/768.0);
+	return 14187578.4/period;
+}
+
+static int TrackerArpeggioPeriod(const TrackerSong *song, int period, int semitones) {
+	if (semitones == 0) return period;
+	if (song->linear) return period - semitones*64;
+	return (int)lrint(period*exp2(-semitones/12.0));
+}
+
+static const TrackerSample *TrackerInstrumentSample(const TrackerSong *song, const TrackerInstrument *instrument, int note) {
+	if (instrument == NULL || note < 0 || note > 95) return NULL;
+	int index = instrument->sampleMap[note];
+	if (index >= instrument->sampleCount || instrument->firstSample + index >= song->sampleCount) return NULL;
+	const TrackerSample *s = &song->samples[instrument->firstSample + index];
+	return s->length > 0 ? s : NULL;
+}
+
+static int TrackerPatternRows(const TrackerSong *song, int order) {
+	int pattern = song->orders[order];
+	return pattern < song->patternCount ? song->patterns[pattern].rows : 64;
+}
+
+static int ClampTracker(int v, int lo, int hi) {
+	return v < lo ? lo : v > hi ? hi : v;
+}
+
+static void InitTrackerPlayer(TrackerPlayer *p, const TrackerSong *song, int rate) {
+	memset(p, 0, sizeof(*p));
+	p->song = song;
+	p->rate = rate;
+	p->mix = MixTrackerRun;
+	p->speed = song->speed;
+	p->bpm = song->bpm;
+	p->globalVolume = 64;
+	p->gain = song->channels <= 4 ? 0.5f : 2.0f/song->channels;
+	for (int i = 0; i < song->channels; i++) {
+		// MOD channels are hard left or right on an Amiga (LRRL), brought closer to the center
+		p->channels[i].panning = song->xm ? 128 : ((i & 3) == 0 || (i & 3) == 3) ? 64 : 192;
+		p->channels[i].fadeout = 65536;
+	}
+}
+
+static void TrackerKeyOff(TrackerChannel *ch) {
+	ch->keyOn = false;
+	if (ch->instrument == NULL || !(ch->instrument->volume.flags & TRACKER_ENVELOPE_ON)) ch->volume = 0;
+}
+
+static void TrackerVolumeSlide(TrackerChannel *ch, int param) {
+	if (param >> 4) ch->volume = ClampTracker(ch->volume + (param >> 4), 0, 64);
+	else ch->volume = ClampTracker(ch->volume - (param & 0x0f), 0, 64);
+}
+
+static void TrackerTonePorta(TrackerChannel *ch) {
+	if (ch->period < ch->targetPeriod) ch->period = ClampTracker(ch->period + ch->portaSpeed*4, ch->period, ch->targetPeriod);
+	else if (ch->period > ch->targetPeriod) ch->period = ClampTracker(ch->period - ch->portaSpeed*4, ch->targetPeriod, ch->period);
+}
+
+static int TrackerWave(int position, int depth) {
+	int v = trackerSine[position & 31]*depth;
+	return (position & 32) ? -v : v;
+}
+
+static void TrackerVibrato(const TrackerSong *song, TrackerChannel *ch) {
+	int v = TrackerWave(ch->vibratoPos, ch->vibratoDepth);
+	ch->vibratoDelta = song->linear ? v >> 6 : (v >> 7)*4;
+	ch->vibratoPos = (ch->vibratoPos + ch->vibratoSpeed) & 63;
+}
+
+// Starts the note of a cell (or the instrument, or a key off) and applies its volume column
+static void TrackerNote(TrackerPlayer *p, TrackerChannel *ch, const TrackerCell *cell) {
+	const TrackerSong *song = p->song;
+	bool porta = cell->effect == 0x3 || cell->effect == 0x5 || (cell->volume >> 4) == 0xf;
+	bool instrument = cell->instrument > 0 && cell->instrument <= song->instrumentCount;
+	if (instrument) ch->instrument = &song->instruments[cell->instrument - 1];
+
+	if (cell->note == TRACKER_KEY_OFF) {
+		TrackerKeyOff(ch);
+		instrument = false;
+	} else if (cell->note > 0) {
+		const TrackerSample *s = TrackerInstrumentSample(song, ch->instrument, cell->note - 1);
+		if (s != NULL) {
+			int period = TrackerNotePeriod(song, ClampTracker(cell->note - 1 + s->relativeNote, 0, 118), s->finetune);
+			if (porta && ch->voice.sample != NULL) {
+				ch->targetPeriod = period;
+			} else {
+				if (cell->effect == 0x9 && cell->param) ch->offset = cell->param;
+				ch->sample = s;
+				ch->period = ch->targetPeriod = period;
+				ch->voice.sample = s;
+				ch->voice.position = cell->effect == 0x9 ? (int64_t)ch->offset*256 << 32 : 0;
+				ch->voice.step = 1;
+				ch->vibratoPos = ch->tremoloPos = 0;
+				instrument = true;
+			}
+		}
+	}
+	if (instrument && ch->sample != NULL) {
+		ch->volume = ch->sample->volume;
+		if (song->xm) ch->panning = ch->sample->panning;
+		ch->keyOn = true;
+		ch->envelopeTick = 0;
+		ch->fadeout = 65536;
+	}
+
+	int v = cell->volume;
+	if (v >= 0x10 && v <= 0x50) ch->volume = v - 0x10;
+	else if ((v >> 4) == 0x8) ch->volume = ClampTracker(ch->volume - (v & 0x0f), 0, 64);
+	else if ((v >> 4) == 0x9) ch->volume = ClampTracker(ch->volume + (v & 0x0f), 0, 64);
+	else if ((v >> 4) == 0xc) ch->panning = (v & 0x0f)*17;
+	else if ((v >> 4) == 0xf && (v & 0x0f)) ch->portaSpeed = (v & 0x0f) << 4;
+}
+
+// Effects of the first tick of a row
+static void TrackerRowEffects(TrackerPlayer *p, TrackerChannel *ch, const TrackerCell *cell) {
+	const TrackerSong *song = p->song;
+	int x = cell->param >> 4, y = cell->param & 0x0f;
+
+	switch (cell->effect) {
+		case 0x1: if (cell->param) ch->portaUp = cell->param; break;
+		case 0x2: if (cell->param) ch->portaDown = cell->param; break;
+		case 0x3: if (cell->param) ch->portaSpeed = cell->param; break;
+		case 0x4:
+			if (x) ch->vibratoSpeed = x;
+			if (y) ch->vibratoDepth = y;
+			break;
+		case 0x5: case 0x6: case 0xa:
+			if (cell->param || !song->xm) ch->volumeSlide = cell->param;      // no memory in MODs
+			break;
+		case 0x7:
+			if (x) ch->tremoloSpeed = x;
+			if (y) ch->tremoloDepth = y;
+			break;
+		case 0x8: ch->panning = cell->param; break;
+		case 0xb:
+			p->jump = true;
+			p->jumpOrder = cell->param;
+			break;
+		case 0xc: ch->volume = cell->param > 64 ? 64 : cell->param; break;
+		case 0xd:
+			p->rowBreak = true;
+			p->breakRow = x*10 + y;
+			break;
+		case 0xe:
+			switch (x) {
+				case 0x1: ch->period -= y*4; break;
+				case 0x2: ch->period += y*4; break;
+				case 0x6:
+					if (y == 0) ch->loopRow = p->row;
+					else {
+						ch->loopCount = ch->loopCount == 0 ? y : ch->loopCount - 1;
+						if (ch->loopCount > 0) {
+							p->loopJump = true;
+							p->loopRow = ch->loopRow;
+						}
+					}
+					break;
+				case 0x8: ch->panning = y*17; break;
+				case 0xa: ch->volume = ClampTracker(ch->volume + y, 0, 64); break;
+				case 0xb: ch->volume = ClampTracker(ch->volume - y, 0, 64); break;
+				case 0xc: if (y == 0) ch->volume = 0; break;
+				case 0xe: if (!p->repeating) p->rowRepeat = y; break;
+			}
+			break;
+		case 0xf:
+			if (cell->param == 0) break;
+			if (cell->param < 32) p->speed = cell->param;
+			else p->bpm = cell->param;
+			break;
+		case 0x10: p->globalVolume = cell->param > 64 ? 64 : cell->param; break;
+		case 0x11: if (cell->param) ch->globalSlide = cell->param; break;
+		case 0x14: if (cell->param == 0) TrackerKeyOff(ch); break;
+		case 0x19: if (cell->param) ch->panSlide = cell->param; break;
+		case 0x21:
+			if (x == 1) ch->period -= y;
+			else if (x == 2) ch->period += y;
+			break;
+	}
+}
+
+// Effects of the other ticks
+static void TrackerTickEffects(TrackerPlayer *p, TrackerChannel *ch) {
+	const TrackerCell *cell = &ch->cell;
+	int x = cell->param >> 4, y = cell->param & 0x0f;
+
+	switch (cell->effect) {
+		case 0x0:
+			if (cell->param) ch->arpeggio = (p->tick % 3 == 1) ? x : (p->tick % 3 == 2) ? y : 0;
+			break;
+		case 0x1: ch->period -= ch->portaUp*4; break;
+		case 0x2: ch->period += ch->portaDown*4; break;
+		case 0x3: TrackerTonePorta(ch); break;
+		case 0x4: TrackerVibrato(p->song, ch); break;
+		case 0x5:
+			TrackerTonePorta(ch);
+			TrackerVolumeSlide(ch, ch->volumeSlide);
+			break;
+		case 0x6:
+			TrackerVibrato(p->song, ch);
+			TrackerVolumeSlide(ch, ch->volumeSlide);
+			break;
+		case 0x7:
+			ch->tremoloDelta = TrackerWave(ch->tremoloPos, ch->tremoloDepth) >> 6;
+			ch->tremoloPos = (ch->tremoloPos + ch->tremoloSpeed) & 63;
+			break;
+		case 0xa: TrackerVolumeSlide(ch, ch->volumeSlide); break;
+		case 0xe:
+			if (x == 0x9 && y && p->tick % y == 0) ch->voice.position = 0;
+			else if (x == 0xc && p->tick == y) ch->volume = 0;
+			else if (x == 0xd && p->tick == y) TrackerNote(p, ch, cell);
+			break;
+		case 0x11:
+			if (ch->globalSlide >> 4) p->globalVolume = ClampTracker(p->globalVolume + (ch->globalSlide >> 4), 0, 64);
+			else p->globalVolume = ClampTracker(p->globalVolume - (ch->globalSlide & 0x0f), 0, 64);
+			break;
+		case 0x14: if (p->tick == cell->param) TrackerKeyOff(ch); break;
+		case 0x19:
+			if (ch->panSlide >> 4) ch->panning = ClampTracker(ch->panning + (ch->panSlide >> 4), 0, 255);
+			else ch->panning = ClampTracker(ch->panning - (ch->panSlide & 0x0f), 0, 255);
+			break;
+	}
+
+	int v = cell->volume;
+	switch (v >> 4) {
+		case 0x6: ch->volume = ClampTracker(ch->volume - (v & 0x0f), 0, 64); break;
+		case 0x7: ch->volume = ClampTracker(ch->volume + (v & 0x0f), 0, 64); break;
+		case 0xd: ch->panning = ClampTracker(ch->panning - (v & 0x0f), 0, 255); break;
+		case 0xe: ch->panning = ClampTracker(ch->panning + (v & 0x0f), 0, 255); break;
+		case 0xf: TrackerTonePorta(ch); break;
+	}
+}
+
+static int TrackerEnvelopeValue(const TrackerEnvelope *e, int tick) {
+	if (tick >= e->x[e->points - 1]) return e->y[e->points - 1];
+	int i = 0;
+	while (i + 2 < e->points && tick >= e->x[i + 1]) i++;
+	int dx = e->x[i + 1] - e->x[i];
+	if (dx <= 0) return e->y[i + 1];
+	return e->y[i] + (e->y[i + 1] - e->y[i])*(tick - e->x[i])/dx;
+}
+
+// Envelope, fadeout and pitch of the tick into the voice
+static void UpdateTrackerVoice(TrackerPlayer *p, TrackerChannel *ch) {
+	const TrackerSong *song = p->song;
+	int envelope = 64;
+	const TrackerEnvelope *e = ch->instrument != NULL ? &ch->instrument->volume : NULL;
+	if (e != NULL && (e->flags & TRACKER_ENVELOPE_ON)) {
+		envelope = TrackerEnvelopeValue(e, ch->envelopeTick);
+		bool held = ch->keyOn && (e->flags & TRACKER_ENVELOPE_SUSTAIN) && ch->envelopeTick == e->x[e->sustain];
+		if (!held) {
+			ch->envelopeTick++;
+			if ((e->flags & TRACKER_ENVELOPE_LOOP) && ch->envelopeTick >= e->x[e->loopEnd]) ch->envelopeTick = e->x[e->loopStart];
+		}
+		if (!ch->keyOn) ch->fadeout = ClampTracker(ch->fadeout - ch->instrument->fadeout*2, 0, 65536);
+	}
+
+	int period = TrackerArpeggioPeriod(song, ch->period + ch->vibratoDelta, ch->arpeggio);
+	if (period < 1) period = 1;
+	int64_t step = (int64_t)(TrackerPeriodFrequency(song, period)/p->rate*4294967296.0);
+	if (step > TRACKER_MAX_STEP) step = TRACKER_MAX_STEP;
+	ch->voice.step = ch->voice.step < 0 ? -step : step;
+
+	float volume = ClampTracker(ch->volume + ch->tremoloDelta, 0, 64)/64.0f*(envelope/64.0f)*(ch->fadeout/65536.0f)*(p->globalVolume/64.0f)*p->gain;
+	ch->voice.left = volume*(255 - ch->panning)/255.0f;
+	ch->voice.right = volume*ch->panning/255.0f;
+}
+
+static void NextTrackerRow(TrackerPlayer *p) {
+	const TrackerSong *song = p->song;
+	if (p->loopJump) {
+		p->row = p->loopRow;
+	} else if (p->jump || p->rowBreak) {
+		p->order = p->jump ? p->jumpOrder : p->order + 1;
+		p->row = p->rowBreak ? p->breakRow : 0;
+	} else if (++p->row >= TrackerPatternRows(song, p->order)) {
+		p->row = 0;
+		p->order++;
+	}
+	p->jump = p->rowBreak = p->loopJump = false;
+
+	if (p->order >= song->length) p->order = song->restart;         // the demo loops its music
+	if (p->row >= TrackerPatternRows(song, p->order)) p->row = 0;
+}
+
+static void TrackerTick(TrackerPlayer *p) {
+	const TrackerSong *song = p->song;
+	for (int c = 0; c < song->channels; c++) p->channels[c].arpeggio = p->channels[c].vibratoDelta = p->channels[c].tremoloDelta = 0;
+
+	if (p->tick == 0 && !p->repeating) {
+		int pattern = song->orders[p->order];
+		for (int c = 0; c < song->channels; c++) {
+			TrackerChannel *ch = &p->channels[c];
+			ch->cell = pattern < song->patternCount ? song->patterns[pattern].cells[p->row*song->channels + c] : (TrackerCell) { 0 };
+			bool delayed = ch->cell.effect == 0xe && (ch->cell.param >> 4) == 0xd && (ch->cell.param & 0x0f);
+			if (!delayed) TrackerNote(p, ch, &ch->cell);
+			TrackerRowEffects(p, ch, &ch->cell);
+		}
+	} else {
+		for (int c = 0; c < song->channels; c++) TrackerTickEffects(p, &p->channels[c]);
+	}
+	for (int c = 0; c < song->channels; c++) UpdateTrackerVoice(p, &p->channels[c]);
+
+	if (++p->tick >= p->speed) {
+		p->tick = 0;
+		p->repeating = p->rowRepeat > 0;
+		if (p->repeating) p->rowRepeat--;
+		else NextTrackerRow(p);
+	}
+}
+
+// Adds 'frames' frames of the song to interleaved stereo 'out', running ticks as they fall due
+static void MixTracker(TrackerPlayer *p, float *out, int frames) {
+	while (frames > 0) {
+		if (p->tickFrames == 0) {
+			TrackerTick(p);
+			p->tickFrames = p->rate*5/(p->bpm*2);
+		}
+		int n = frames < p->tickFrames ? frames : p->tickFrames;
+		for (int c = 0; c < p->song->channels; c++) MixTrackerVoice(&p->channels[c].voice, out, n, p->mix);
+		out += 2*n;
+		frames -= n;
+		p->tickFrames -= n;
+	}
+}
+
+static void RenderTracker(TrackerPlayer *p, short *out, int frames) {
+	while (frames > 0) {
+		int n = frames < TRACKER_CHUNK ? frames : TRACKER_CHUNK;
+		memset(p->mixBuffer, 0, n*2*sizeof(float));
+		MixTracker(p, p->mixBuffer, n);
+		ConvertTrackerFrames(p->mixBuffer, out, n*2);
+		out += 2*n;
+		frames -= n;
+	}
+}
+
+// -------------------------------------------------------------------------------------------------------------
+// Mixer thread
+
+static void *TrackerStreamThread(void *arg) {
+	TrackerStream *stream = (TrackerStream *)arg;
+
+	pthread_mutex_lock(&stream->mutex);
+	while (true) {
+		while (stream->filled == TRACKER_BUFFERS && !stream->quit) pthread_cond_wait(&stream->changed, &stream->mutex);
+		if (stream->quit) break;
+		int index = (stream->readIndex + stream->filled) % TRACKER_BUFFERS;
+		pthread_mutex_unlock(&stream->mutex);
+
+		struct timespec t0, t1;
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		RenderTracker(&stream->player, stream->buffers[index], stream->frames);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+
+		pthread_mutex_lock(&stream->mutex);
+		stream->mixSeconds += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec)*1e-9;
+		stream->mixedFrames += stream->frames;
+		stream->filled++;
+		pthread_cond_broadcast(&stream->changed);
+	}
+	pthread_mutex_unlock(&stream->mutex);
+	return NULL;
+}
+
+// Loads the module and starts mixing it, 'frames' frames per buffer; NULL when it does not load or does not fit
+static TrackerStream *LoadTrackerStream(const unsigned char *data, size_t size, int rate, int frames) {
+	TrackerStream *stream = (TrackerStream *)calloc(1, sizeof(TrackerStream));
+	if (stream == NULL) return NULL;
+	if (!LoadTrackerSong(data, size, &stream->song)) {
+		free(stream);
+		return NULL;
+	}
+
+	InitTrackerPlayer(&stream->player, &stream->song, rate);
+	stream->frames = frames;
+	bool allocated = true;
+	for (int i = 0; i < TRACKER_BUFFERS; i++) {
+		stream->buffers[i] = (short *)malloc((size_t)frames*2*sizeof(short));
+		if (stream->buffers[i] == NULL) allocated = false;
+	}
+	if (!allocated) TraceLog(LOG_WARNING, "TRACKER: could not allocate the mix buffers");
+	pthread_mutex_init(&stream->mutex, NULL);
+	pthread_cond_init(&stream->changed, NULL);
+	if (!allocated || pthread_create(&stream->thread, NULL, TrackerStreamThread, stream) != 0) {
+		pthread_cond_destroy(&stream->changed);
+		pthread_mutex_destroy(&stream->mutex);
+		for (int i = 0; i < TRACKER_BUFFERS; i++) free(stream->buffers[i]);
+		UnloadTrackerSong(&stream->song);
+		free(stream);
+		return NULL;
+	}
+	TraceLog(LOG_INFO, "TRACKER: \"%.20s\", %s, %i channels, %i patterns, %i samples, %i KB", stream->song.name, stream->song.xm ? "XM" : "MOD",
+		stream->song.channels, stream->song.patternCount, stream->song.sampleCount, (int)(stream->song.bytes/1024));
+	return stream;
+}
+
+static size_t TrackerStreamBytes(const TrackerStream *stream) {
+	return sizeof(TrackerStream) + stream->song.bytes + (size_t)TRACKER_BUFFERS*stream->frames*2*sizeof(short);
+}
+
+// The next mixed buffer, waits for the mixer if it fell behind; hand it back with ReleaseTrackerBuffer()
+static const short *AcquireTrackerBuffer(TrackerStream *stream) {
+	pthread_mutex_lock(&stream->mutex);
+	while (stream->filled == 0) pthread_cond_wait(&stream->changed, &stream->mutex);
+	const short *buffer = stream->buffers[stream->readIndex];
+	pthread_mutex_unlock(&stream->mutex);
+	return buffer;
+}
+
+static void ReleaseTrackerBuffer(TrackerStream *stream) {
+	pthread_mutex_lock(&stream->mutex);
+	stream->readIndex = (stream->readIndex + 1) % TRACKER_BUFFERS;
+	stream->filled--;
+	pthread_cond_broadcast(&stream->changed);
+	pthread_mutex_unlock(&stream->mutex);
+}
+
+static void UnloadTrackerStream(TrackerStream *stream) {
+	pthread_mutex_lock(&stream->mutex);
+	stream->quit = true;
+	pthread_cond_broadcast(&stream->changed);
+	pthread_mutex_unlock(&stream->mutex);
+	pthread_join(stream->thread, NULL);
+
+	if (stream->mixedFrames > 0) {
+		double seconds = (double)stream->mixedFrames/stream->player.rate;
+		TraceLog(LOG_INFO, "TRACKER: mixed %.1f s of audio in %.1f ms, %.2f%% of a core", seconds, stream->mixSeconds*1000.0, stream->mixSeconds/seconds*100.0);
+	}
+	pthread_mutex_destroy(&stream->mutex);
+	pthread_cond_destroy(&stream->changed);
+	for (int i = 0; i < TRACKER_BUFFERS; i++) free(stream->buffers[i]);
+	UnloadTrackerSong(&stream->song);
+	free(stream);
+}
+
+#endif